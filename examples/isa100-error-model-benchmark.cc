@@ -0,0 +1,99 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 The University Of Calgary- FISHLAB
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Compares the lookup table mode of Isa100ErrorModel against the analytic expression.
+ * - Reports the largest absolute error of the chunk success rate over a sweep of SINR
+ *   and chunk lengths.
+ * - Reports the time taken by each mode to evaluate the same set of chunks.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/isa100-11a-module.h"
+
+#include <ctime>
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  double maxError = 1e-4;
+  uint32_t numRepeats = 200;
+
+  CommandLine cmd;
+  cmd.AddValue ("maxError", "Accuracy bound of the lookup table", maxError);
+  cmd.AddValue ("repeats", "Number of times the sweep is repeated for timing", numRepeats);
+  cmd.Parse (argc, argv);
+
+  Ptr<Isa100ErrorModel> errorModel = CreateObject<Isa100ErrorModel> ();
+  errorModel->SetAttribute ("UseLookupTable", BooleanValue (true));
+  errorModel->SetAttribute ("MaxLookupError", DoubleValue (maxError));
+
+  // Build the table up front so it isn't included in the timing.
+  const Isa100ErrorModelTable *table = errorModel->GetLookupTable ();
+  std::cout << "Table: " << table->m_logSuccess.size () << " entries, " << table->m_stepDb << " dB spacing\n";
+
+  // Sweep the SINR over the transition region with a spacing that doesn't line up with the table.
+  std::vector<double> sinrs;
+  for (double sinrDb = -5.0; sinrDb <= 15.0; sinrDb += 0.0137)
+    {
+      sinrs.push_back (std::pow (10.0, sinrDb / 10.0));
+    }
+
+  uint32_t lengths[] = { 8, 48, 160, 408, 1016 };
+  uint32_t numLengths = sizeof (lengths) / sizeof (lengths[0]);
+
+  // Accuracy
+  double worstError = 0.0;
+  for (uint32_t i = 0; i < sinrs.size (); i++)
+    {
+      for (uint32_t j = 0; j < numLengths; j++)
+        {
+          double error = std::fabs (errorModel->GetChunkSuccessRate (sinrs[i], lengths[j])
+                                    - errorModel->GetAnalyticChunkSuccessRate (sinrs[i], lengths[j]));
+          worstError = std::max (worstError, error);
+        }
+    }
+  std::cout << "Max absolute error: " << worstError << " (bound " << maxError << ")\n";
+
+  // Timing
+  double sum = 0.0;
+  std::clock_t start = std::clock ();
+  for (uint32_t r = 0; r < numRepeats; r++)
+    for (uint32_t i = 0; i < sinrs.size (); i++)
+      for (uint32_t j = 0; j < numLengths; j++)
+        sum += errorModel->GetAnalyticChunkSuccessRate (sinrs[i], lengths[j]);
+  double analyticSec = (double)(std::clock () - start) / CLOCKS_PER_SEC;
+
+  start = std::clock ();
+  for (uint32_t r = 0; r < numRepeats; r++)
+    for (uint32_t i = 0; i < sinrs.size (); i++)
+      for (uint32_t j = 0; j < numLengths; j++)
+        sum += errorModel->GetChunkSuccessRate (sinrs[i], lengths[j]);
+  double tableSec = (double)(std::clock () - start) / CLOCKS_PER_SEC;
+
+  double numCalls = (double)numRepeats * sinrs.size () * numLengths;
+  std::cout << "Analytic: " << analyticSec << " s (" << analyticSec / numCalls * 1e9 << " ns/call)\n";
+  std::cout << "Table:    " << tableSec << " s (" << tableSec / numCalls * 1e9 << " ns/call)\n";
+  std::cout << "Checksum: " << sum << "\n";
+
+  return 0;
+}
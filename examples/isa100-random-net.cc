@@ -76,7 +76,6 @@ NS_LOG_COMPONENT_DEFINE ("RandomNetworkTdma");
 
 // Global variables for simulation termination.
 double networkLifetime;
-Time terminateCheckPeriod;
 int terminateSim = 0;
 
 // ************************ CALLBACK FUNCTIONS ******************************
@@ -87,21 +86,12 @@ void BatteryDepletionCallbackEvent(Mac16Address addr)
 		networkLifetime = (Simulator::Now()).GetSeconds();
 		NS_LOG_UNCOND(" Node " << addr << " out of energy at " << networkLifetime);
 		terminateSim = 1;
-	}
-
-//	Simulator::Stop();
-}
 
-
-
-static void TerminateSimulation()
-{
-	if(terminateSim){
+		// The batteries predict their depletion time so this is called at the exact instant
+		// the first node runs out of energy.
 		NS_LOG_UNCOND(" Simulation terminated!");
 		Simulator::Stop();
 	}
-	else
-	  Simulator::Schedule(terminateCheckPeriod,&TerminateSimulation);
 }
 
 static void PrintDropPacket ( Ptr<OutputStreamWrapper> stream, Mac16Address addr, Ptr<const Packet> p, std::string message)
@@ -232,10 +222,9 @@ int main (int argc, char *argv[])
 
 
 
-  terminateCheckPeriod = Seconds(numSlotsPerFrame*slotDuration.GetSeconds());
-  Simulator::Schedule(terminateCheckPeriod/2,&TerminateSimulation);
+  Time samplePeriod = Seconds(numSlotsPerFrame*slotDuration.GetSeconds());
 
-  NS_LOG_UNCOND("Sample update period " << terminateCheckPeriod.GetSeconds() << " s");
+  NS_LOG_UNCOND("Sample update period " << samplePeriod.GetSeconds() << " s");
 
   NS_ASSERT(numSensorNodes > 0);
   NS_ASSERT(iter >= 0);
@@ -272,8 +261,8 @@ int main (int argc, char *argv[])
     NS_FATAL_ERROR("Number of transmit nodes cannot be zero!");
   }
 
-  // Cannot simulate more than 256 nodes
-  NS_ASSERT_MSG(numNodes <= 256, "Simulation can only support upto 256 nodes total. Num Nodes = " << numNodes);
+  // Node addresses are 16 bits
+  NS_ASSERT_MSG(numNodes <= 65536, "Simulation can only support upto 65536 nodes total. Num Nodes = " << numNodes);
 
 	// Change the random number seed to alter the random number sequence used by the simulator.
   RngSeedManager::SetSeed (seed);
@@ -313,7 +302,8 @@ int main (int argc, char *argv[])
   // ********************************************* CHANNEL MODEL ************************************************
 
   NS_LOG_UNCOND("Constructing the channel model...");
-  Ptr<SingleModelSpectrumChannel> channel = CreateObject<SingleModelSpectrumChannel> ();
+  // Stationary network, so signals only need to be delivered to the nodes that can hear them.
+  Ptr<FishSpectrumChannel> channel = CreateObject<FishSpectrumChannel> ();
   Ptr<FishLogDistanceLossModel> propLossModel = CreateObject<FishLogDistanceLossModel> ();
   Ptr<ConstantSpeedPropagationDelayModel> propDelayModel = CreateObject<ConstantSpeedPropagationDelayModel> ();
 
@@ -421,6 +411,7 @@ int main (int argc, char *argv[])
 
 		Ptr<Isa100Battery> battery = CreateObject<Isa100Battery>();
 
+		battery->SetAttribute("PredictDepletion", BooleanValue(true));
 		battery->SetInitEnergy(DEFAULT_INITIAL_ENERGY_J*1e6);
 		battery->SetBatteryDepletionCallback(MakeCallback(&BatteryDepletionCallbackEvent));
 
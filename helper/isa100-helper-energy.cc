@@ -0,0 +1,130 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 The University Of Calgary- FISHLAB
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Geoffrey Messier <gmessier@ucalgary.ca>
+ */
+
+
+#include "ns3/isa100-helper.h"
+
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/isa100-net-device.h"
+#include "ns3/isa100-battery.h"
+
+#include <algorithm>
+
+
+NS_LOG_COMPONENT_DEFINE ("Isa100HelperEnergy");
+
+namespace ns3 {
+
+static void
+WriteEnergyCategoriesText(Ptr<OutputStreamWrapper> stream, Mac16Address addr, const std::vector<std::string> &names)
+{
+	std::ostream *os = stream->GetStream();
+
+	*os << "Categories," << addr << ",StartNs,EndNs,Address,EnergyLeft";
+	for(uint32_t n=0; n < names.size(); n++)
+		*os << "," << names[n];
+	*os << "\n";
+}
+
+static void
+WriteEnergyCategoriesBinary(Ptr<OutputStreamWrapper> stream, Mac16Address addr, const std::vector<std::string> &names)
+{
+	std::ostream *os = stream->GetStream();
+
+	uint8_t type = 0;
+	uint8_t addrBytes[2];
+	addr.CopyTo(addrBytes);
+	uint16_t numCategories = names.size();
+
+	os->write((const char *)&type, sizeof(type));
+	os->write((const char *)addrBytes, sizeof(addrBytes));
+	os->write((const char *)&numCategories, sizeof(numCategories));
+
+	for(uint32_t n=0; n < names.size(); n++){
+		uint8_t len = std::min<size_t>(names[n].size(), 255);
+		os->write((const char *)&len, sizeof(len));
+		os->write(names[n].data(), len);
+	}
+}
+
+static void
+WriteEnergyRecordText(Ptr<OutputStreamWrapper> stream, Mac16Address addr, Time start,
+		const std::vector<double> &breakdown, double energy)
+{
+	std::ostream *os = stream->GetStream();
+
+	*os << start.GetNanoSeconds() << "," << Simulator::Now().GetNanoSeconds() << "," << addr << "," << energy;
+	for(uint32_t n=0; n < breakdown.size(); n++)
+		*os << "," << breakdown[n];
+	*os << "\n";
+}
+
+static void
+WriteEnergyRecordBinary(Ptr<OutputStreamWrapper> stream, Mac16Address addr, Time start,
+		const std::vector<double> &breakdown, double energy)
+{
+	std::ostream *os = stream->GetStream();
+
+	uint8_t type = 1;
+	uint8_t addrBytes[2];
+	addr.CopyTo(addrBytes);
+	int64_t startNs = start.GetNanoSeconds();
+	int64_t timeNs = Simulator::Now().GetNanoSeconds();
+	uint16_t numCategories = breakdown.size();
+
+	os->write((const char *)&type, sizeof(type));
+	os->write((const char *)addrBytes, sizeof(addrBytes));
+	os->write((const char *)&startNs, sizeof(startNs));
+	os->write((const char *)&timeNs, sizeof(timeNs));
+	os->write((const char *)&energy, sizeof(energy));
+	os->write((const char *)&numCategories, sizeof(numCategories));
+	if(numCategories)
+		os->write((const char *)&breakdown[0], numCategories * sizeof(double));
+}
+
+void
+Isa100Helper::EnableAggregatedEnergyTrace(Ptr<OutputStreamWrapper> stream, bool binary)
+{
+  NS_LOG_FUNCTION (this << binary);
+
+  for(uint32_t i=0; i < m_devices.GetN(); i++){
+  	Ptr<Isa100Battery> battery = m_devices.Get(i)->GetObject<Isa100NetDevice>()->GetBattery();
+  	if(!battery)
+  		continue;
+
+  	Mac16Address addr = Mac16Address::ConvertFrom(m_devices.Get(i)->GetAddress());
+
+  	if(binary){
+  		WriteEnergyCategoriesBinary(stream, addr, battery->GetCategoryNames());
+  		battery->TraceConnectWithoutContext("AggregatedEnergyConsumption", MakeBoundCallback(&WriteEnergyRecordBinary, stream));
+  	}
+  	else{
+  		WriteEnergyCategoriesText(stream, addr, battery->GetCategoryNames());
+  		battery->TraceConnectWithoutContext("AggregatedEnergyConsumption", MakeBoundCallback(&WriteEnergyRecordText, stream));
+  	}
+
+  	battery->SetAttribute("AggregateEnergyTrace", BooleanValue(true));
+  }
+}
+
+} // namespace ns3
@@ -0,0 +1,215 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 The University Of Calgary- FISHLAB
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Geoffrey Messier <gmessier@ucalgary.ca>
+ */
+
+
+#include "ns3/isa100-helper.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/isa100-net-device.h"
+#include "ns3/isa100-battery.h"
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+
+NS_LOG_COMPONENT_DEFINE ("Isa100HelperLifetime");
+
+namespace ns3 {
+
+void
+Isa100Helper::EnableLifetimeFastForward(bool resume, Time samplePeriod)
+{
+  NS_LOG_FUNCTION (this << resume << samplePeriod);
+
+  if(m_devices.GetN() == 0)
+  	NS_FATAL_ERROR("Lifetime fast forward enabled before the net devices were installed.");
+
+  // Steady state consumption requires a deterministic schedule in every superframe the DL runs.
+  for(uint32_t i=0; i < m_devices.GetN(); i++){
+  	Ptr<Isa100Dl> dl = m_devices.Get(i)->GetObject<Isa100NetDevice>()->GetDl();
+  	if(!dl->GetNumDlSfSchedules())
+  		NS_FATAL_ERROR("Lifetime fast forward enabled before the superframe schedules were installed.");
+
+  	for(uint32_t sf=0; sf < dl->GetNumDlSfSchedules(); sf++){
+  		Ptr<Isa100DlSfSchedule> schedule = dl->GetDlSfSchedule(sf);
+  		if(!schedule)
+  			NS_FATAL_ERROR("Lifetime fast forward enabled before the superframe schedules were installed.");
+
+  		std::vector<DlLinkType> *types = schedule->GetLinkSlotTypes();
+  		for(uint32_t n=0; n < types->size(); n++){
+  			if((*types)[n] == SHARED)
+  				NS_FATAL_ERROR("Lifetime fast forward requires a dedicated slot TDMA schedule (node " << i << " has a SHARED link in superframe " << sf << ").");
+  		}
+  	}
+  }
+
+  // Sample over the merged superframe timeline so the consumption pattern of every node repeats a whole
+  // number of times per sample.  Devices can run different superframe sets so the common multiple is used.
+  if(samplePeriod.IsZero()){
+  	int64_t period = 1;
+  	for(uint32_t i=0; i < m_devices.GetN(); i++){
+  		int64_t timeline = m_devices.Get(i)->GetObject<Isa100NetDevice>()->GetDl()->GetTimelinePeriod().GetInteger();
+  		int64_t a = period, b = timeline;
+  		while(b){
+  			int64_t r = a % b;
+  			a = b;
+  			b = r;
+  		}
+  		period = period / a * timeline;
+  	}
+  	samplePeriod = TimeStep(period);
+  }
+
+  NS_ASSERT(samplePeriod.IsStrictlyPositive());
+
+  m_ffResume = resume;
+  m_ffSamplePeriod = samplePeriod;
+  m_lifetimeEstimate = -1;
+  m_lifetimeErrorBound = 0;
+  m_ffSkippedTime = Seconds(0.0);
+
+  m_ffLastEnergy.assign(m_devices.GetN(), 0.0);
+  m_ffDeltas.assign(m_devices.GetN(), std::deque<double> ());
+  for(uint32_t i=0; i < m_devices.GetN(); i++){
+  	Ptr<Isa100Battery> battery = m_devices.Get(i)->GetObject<Isa100NetDevice>()->GetBattery();
+  	if(battery)
+  		m_ffLastEnergy[i] = battery->GetRemainingEnergy();
+  }
+
+  m_ffEvent.Cancel();
+  m_ffEvent = Simulator::Schedule(m_ffSamplePeriod,&Isa100Helper::SampleLifetimeEnergy,this);
+}
+
+double
+Isa100Helper::GetLifetimeEstimate() const
+{
+	return m_lifetimeEstimate;
+}
+
+double
+Isa100Helper::GetLifetimeErrorBound() const
+{
+	return m_lifetimeErrorBound;
+}
+
+Time
+Isa100Helper::GetFastForwardTime() const
+{
+	return m_ffSkippedTime;
+}
+
+void
+Isa100Helper::SampleLifetimeEnergy()
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t numDevices = m_devices.GetN();
+  std::vector<double> meanDelta(numDevices, 0.0);
+
+  bool converged = true;
+  double maxDeviation = 0;
+  double minFrames = std::numeric_limits<double>::max();
+  int32_t firstNode = -1;
+
+  for(uint32_t i=0; i < numDevices; i++){
+  	Ptr<Isa100Battery> battery = m_devices.Get(i)->GetObject<Isa100NetDevice>()->GetBattery();
+  	if(!battery)
+  		continue;
+
+  	double energy = battery->GetRemainingEnergy();
+  	std::deque<double> &deltas = m_ffDeltas[i];
+  	deltas.push_back(m_ffLastEnergy[i] - energy);
+  	if(deltas.size() > m_ffFrames)
+  		deltas.pop_front();
+  	m_ffLastEnergy[i] = energy;
+
+  	if(deltas.size() < m_ffFrames){
+  		converged = false;
+  		continue;
+  	}
+
+  	double sum = 0;
+  	for(uint32_t n=0; n < deltas.size(); n++)
+  		sum += deltas[n];
+  	meanDelta[i] = sum / deltas.size();
+
+  	// Nodes that don't draw any energy never deplete.
+  	if(meanDelta[i] <= 0)
+  		continue;
+
+  	double deviation = 0;
+  	for(uint32_t n=0; n < deltas.size(); n++)
+  		deviation = std::max(deviation, std::fabs(deltas[n] - meanDelta[i]) / meanDelta[i]);
+
+  	maxDeviation = std::max(maxDeviation, deviation);
+  	if(deviation > m_ffTolerance)
+  		converged = false;
+
+  	double frames = energy / meanDelta[i];
+  	if(frames < minFrames){
+  		minFrames = frames;
+  		firstNode = i;
+  	}
+  }
+
+  if(!converged || firstNode < 0){
+  	m_ffEvent = Simulator::Schedule(m_ffSamplePeriod,&Isa100Helper::SampleLifetimeEnergy,this);
+  	return;
+  }
+
+  // The consumption per superframe of every node is within maxDeviation of its mean, which bounds the
+  // error in the number of remaining superframes.  One superframe is added since depletion can occur
+  // anywhere within the last superframe.
+  double framePeriod = m_ffSamplePeriod.GetSeconds();
+  m_lifetimeEstimate = Simulator::Now().GetSeconds() + minFrames * framePeriod;
+  m_lifetimeErrorBound = minFrames * framePeriod * maxDeviation / (1.0 - maxDeviation) + framePeriod;
+
+  Mac16Address firstAddr = Mac16Address::ConvertFrom(m_devices.Get(firstNode)->GetAddress());
+
+  NS_LOG_INFO(" Energy consumption converged at " << Simulator::Now().GetSeconds() << "s, node " << firstAddr
+  		<< " depletes first.  Lifetime: " << m_lifetimeEstimate << " +/- " << m_lifetimeErrorBound << " s");
+
+  m_lifetimeTrace(m_lifetimeEstimate, m_lifetimeErrorBound, firstAddr);
+
+  if(!m_ffResume){
+  	Simulator::Stop();
+  	return;
+  }
+
+  // Skip all but the last few superframes before the first depletion by draining each battery by its
+  // steady state consumption.
+  double skipFrames = std::floor(minFrames) - m_ffResumeFrames;
+  if(skipFrames <= 0)
+  	return;
+
+  for(uint32_t i=0; i < numDevices; i++){
+  	Ptr<Isa100Battery> battery = m_devices.Get(i)->GetObject<Isa100NetDevice>()->GetBattery();
+  	if(battery && meanDelta[i] > 0)
+  		battery->DrainEnergy(skipFrames * meanDelta[i]);
+  }
+
+  m_ffSkippedTime = Seconds(skipFrames * framePeriod);
+
+  NS_LOG_INFO(" Skipped " << skipFrames << " superframes (" << m_ffSkippedTime.GetSeconds() << " s)");
+}
+
+} // namespace ns3
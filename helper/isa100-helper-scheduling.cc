@@ -68,6 +68,25 @@ void Isa100Helper::SetSfSchedule(
 
 }
 
+void Isa100Helper::AddSfSchedule(
+		uint32_t nodeInd, uint8_t *hopPattern, uint32_t numHop,
+		uint16_t *linkSched, DlLinkType *linkTypes, uint32_t numLink,
+		uint16_t period, uint8_t priority
+		)
+{
+	Ptr<NetDevice> baseDevice = m_devices.Get(nodeInd);
+	Ptr<Isa100NetDevice> netDevice = baseDevice->GetObject<Isa100NetDevice>();
+
+	if(!netDevice)
+		NS_FATAL_ERROR("Installing schedule on non-existent ISA100 net device.");
+
+	Ptr<Isa100DlSfSchedule> schedulePtr = CreateObject<Isa100DlSfSchedule>();
+	schedulePtr->SetSchedule(hopPattern,numHop,linkSched,linkTypes,numLink);
+	schedulePtr->SetPeriod(period);
+	schedulePtr->SetPriority(priority);
+	netDevice->GetDl()->AddDlSfSchedule(schedulePtr);
+}
+
 
 void Isa100Helper::SetTdmaOptAttribute(std::string n, const AttributeValue &v)
 {
@@ -160,7 +179,7 @@ SchedulingResult Isa100Helper::ScheduleAndRouteTdma(vector< vector<int> > flows,
 	SchedulingResult schedulingResult = SCHEDULE_FOUND;
 
   vector<NodeSchedule> nodeSchedules(numNodes);
-  vector<std::string> routingStrings(numNodes,"No Route");
+  vector< vector<Mac16Address> > routes(numNodes);
   vector< vector<int> > scheduleSummary;
 
   schedulingResult = FlowMatrixToTdmaSchedule(nodeSchedules,scheduleSummary,flows);
@@ -168,7 +187,7 @@ SchedulingResult Isa100Helper::ScheduleAndRouteTdma(vector< vector<int> > flows,
   if(schedulingResult != SCHEDULE_FOUND)
   	return schedulingResult;
 
-  schedulingResult = CalculateSourceRouteStrings(routingStrings,scheduleSummary);
+  schedulingResult = CalculateSourceRoutes(routes,scheduleSummary);
 
   if(schedulingResult != SCHEDULE_FOUND)
   	return schedulingResult;
@@ -184,18 +203,8 @@ SchedulingResult Isa100Helper::ScheduleAndRouteTdma(vector< vector<int> > flows,
 
     // Create routing object only for field nodes
     // NOTE: This current implementation only allows for a single path from a field node to the sink.
-    if(nNode > 0)
-    {
-    	std::string routingTable[] = { routingStrings[ nNode ] };
-    	int numNodes = 1;
-
-    	Ptr<Isa100RoutingAlgorithm> routingAlgorithm = CreateObject<Isa100SourceRoutingAlgorithm>(numNodes,routingTable);
-    	netDevice->GetDl()->SetRoutingAlgorithm(routingAlgorithm);
-
-    	Mac16AddressValue address;
-    	netDevice->GetDl()->GetAttribute("Address",address);
-    	netDevice->GetDl()->GetRoutingAlgorithm()->SetAttribute("Address",address);
-    }
+    if(nNode > 0 && !routes[nNode].empty())
+    	SetSourceRoute(nNode, Mac16Address("00:00"), routes[nNode]);
 
     // Set the tx power levels in DL
     netDevice->GetDl()->SetTxPowersDbm(m_txPwrDbm[nNode], numNodes);
@@ -433,9 +442,9 @@ bool Isa100Helper::NoParentInQ(int node, vector<int> q, vector< vector<int> > &p
 
 // ... Source Routing List Generation ...
 
-SchedulingResult Isa100Helper::CalculateSourceRouteStrings(vector<std::string> &routingStrings, vector< vector<int> > schedule)
+SchedulingResult Isa100Helper::CalculateSourceRoutes(vector< vector<Mac16Address> > &routes, const vector< vector<int> > &schedule)
 {
-	NS_LOG_DEBUG("Routing Strings: ");
+	NS_LOG_DEBUG("Source Routes: ");
 
 	vector<int> hopCount;
 
@@ -445,32 +454,24 @@ SchedulingResult Isa100Helper::CalculateSourceRouteStrings(vector<std::string> &
 		unsigned int nextNode = schedule[nSlot][1];
 		unsigned int startNode = curNode;
 
-		if(routingStrings[startNode] == "No Route"){
+		if(routes[startNode].empty()){
 
 			// Follow the path to the sink taking the lowest node index when the path branches.
-			std::stringstream ss;
-			bool firstEntry = true;
-			int numHops = 0;
+			vector<Mac16Address> &route = routes[startNode];
 			while(curNode != 0){
 
-				unsigned int upperByte = (nextNode & 0xff00) >> 8;
-				unsigned int lowerByte = (nextNode & 0xff);
-
-				if(firstEntry)
-					firstEntry = false;
-				else
-					ss << " ";
-
-				ss << std::setfill('0') << std::setw(2) << std::hex << upperByte;
-				ss << ":";
-				ss << std::setfill('0') << std::setw(2) << std::hex << lowerByte;
-
+				uint8_t addrBuffer[2];
+				addrBuffer[0] = (nextNode & 0xff00) >> 8;
+				addrBuffer[1] = (nextNode & 0xff);
+				Mac16Address hopAddr;
+				hopAddr.CopyFrom(addrBuffer);
+				route.push_back(hopAddr);
 
 				curNode = nextNode;
 				if(curNode != 0){
 
 					int iNext = nSlot+1;
-					for(; schedule[iNext][0] != curNode && iNext < schedule.size(); iNext++) ;
+					for(; iNext < schedule.size() && schedule[iNext][0] != curNode; iNext++) ;
 
 					if(iNext == schedule.size())
 						return NO_ROUTE;
@@ -478,14 +479,12 @@ SchedulingResult Isa100Helper::CalculateSourceRouteStrings(vector<std::string> &
 					nextNode = schedule[iNext][1];
 
 				}
-				numHops++;
 
 			}
 
-			NS_LOG_DEBUG(" Node " << startNode << ": " << ss.str());
+			NS_LOG_DEBUG(" Node " << startNode << ": " << route.size() << " hops");
 
-			routingStrings[ startNode ] = ss.str();
-			hopCount.push_back(numHops);
+			hopCount.push_back(route.size());
 		}
 	}
 
@@ -65,6 +65,29 @@ Isa100Helper::GetTypeId (void)
         MakeTraceSourceAccessor (&Isa100Helper::m_hopTrace),
 				"ns3::TracedCallback::Hops")
 
+    .AddTraceSource("LifetimeEstimate",
+        "Network lifetime extrapolated from the steady state energy consumption.",
+        MakeTraceSourceAccessor (&Isa100Helper::m_lifetimeTrace),
+        "ns3::TracedCallback::Lifetime")
+
+    .AddAttribute ("FastForwardTolerance",
+        "Max relative deviation of the per-superframe energy consumption from its mean for it to be considered converged.",
+        DoubleValue (1e-3),
+        MakeDoubleAccessor (&Isa100Helper::m_ffTolerance),
+        MakeDoubleChecker<double> (0.0, 0.5))
+
+    .AddAttribute ("FastForwardFrames",
+        "Number of superframes the energy consumption must be stable for before extrapolating.",
+        UintegerValue (5),
+        MakeUintegerAccessor (&Isa100Helper::m_ffFrames),
+        MakeUintegerChecker<uint32_t> (2))
+
+    .AddAttribute ("FastForwardResumeFrames",
+        "Number of superframes before the first depletion at which the full simulation resumes.",
+        UintegerValue (10),
+        MakeUintegerAccessor (&Isa100Helper::m_ffResumeFrames),
+        MakeUintegerChecker<uint32_t> ())
+
   ;
   return tid;
 }
@@ -76,10 +99,20 @@ Isa100Helper::Isa100Helper(void)
   NS_LOG_FUNCTION (this);
 
   m_txPwrDbm = 0;
+
+  m_ffResume = false;
+  m_ffTolerance = 1e-3;
+  m_ffFrames = 5;
+  m_ffResumeFrames = 10;
+  m_lifetimeEstimate = -1;
+  m_lifetimeErrorBound = 0;
+  m_ffSkippedTime = Seconds(0.0);
 }
 
 Isa100Helper::~Isa100Helper(void)
 {
+	m_ffEvent.Cancel();
+
 	if(m_txPwrDbm){
 		for(int i=0; i < m_devices.GetN(); i++)
   			delete[] m_txPwrDbm[i];
@@ -124,6 +157,20 @@ NetDeviceContainer Isa100Helper::Install (NodeContainer c, Ptr<SingleModelSpectr
 
 
 void Isa100Helper::SetSourceRoutingTable(uint32_t nodeInd, uint32_t numNodes,  std::string *routingTable)
+{
+	for(uint32_t iDest=0; iDest < numNodes; iDest++){
+
+		uint8_t addrBuffer[2];
+		addrBuffer[0] = iDest >> 8;
+		addrBuffer[1] = iDest & 0xff;
+		Mac16Address dest;
+		dest.CopyFrom(addrBuffer);
+
+		SetSourceRoute(nodeInd, dest, Isa100SourceRouteTable::ParseRoute(routingTable[iDest]));
+	}
+}
+
+void Isa100Helper::SetSourceRoute(uint32_t nodeInd, Mac16Address dest, const std::vector<Mac16Address> &route)
 {
 	Ptr<NetDevice> baseDevice = m_devices.Get(nodeInd);
 	Ptr<Isa100NetDevice> netDevice = baseDevice->GetObject<Isa100NetDevice>();
@@ -131,14 +178,60 @@ void Isa100Helper::SetSourceRoutingTable(uint32_t nodeInd, uint32_t numNodes,  s
 	if(!baseDevice || !netDevice)
 		NS_FATAL_ERROR("Installing routing table on non-existent ISA100 net device.");
 
-	Ptr<Isa100RoutingAlgorithm> routingAlgorithm = CreateObject<Isa100SourceRoutingAlgorithm>(numNodes,routingTable);
+	if(!m_sourceRouteTable)
+		m_sourceRouteTable = CreateObject<Isa100SourceRouteTable>();
+
+	Ptr<Isa100SourceRoutingAlgorithm> routingAlgorithm = DynamicCast<Isa100SourceRoutingAlgorithm>(netDevice->GetDl()->GetRoutingAlgorithm());
+
+	if(!routingAlgorithm){
+		routingAlgorithm = CreateObject<Isa100SourceRoutingAlgorithm>(m_sourceRouteTable);
+		netDevice->GetDl()->SetRoutingAlgorithm(routingAlgorithm);
+
+		Mac16AddressValue address;
+		netDevice->GetDl()->GetAttribute("Address",address);
+		routingAlgorithm->SetAttribute("Address",address);
+	}
+
+	routingAlgorithm->SetRoute(dest,route);
+}
+
+static Ptr<Isa100GraphRoutingAlgorithm>
+GetGraphRouting(Ptr<Isa100NetDevice> netDevice)
+{
+	Ptr<Isa100GraphRoutingAlgorithm> routingAlgorithm = DynamicCast<Isa100GraphRoutingAlgorithm>(netDevice->GetDl()->GetRoutingAlgorithm());
 
-	netDevice->GetDl()->SetRoutingAlgorithm(routingAlgorithm);
+	if(!routingAlgorithm){
+		routingAlgorithm = CreateObject<Isa100GraphRoutingAlgorithm>();
+		netDevice->GetDl()->SetRoutingAlgorithm(routingAlgorithm);
 
-	Mac16AddressValue address;
-	netDevice->GetDl()->GetAttribute("Address",address);
-	netDevice->GetDl()->GetRoutingAlgorithm()->SetAttribute("Address",address);
+		Mac16AddressValue address;
+		netDevice->GetDl()->GetAttribute("Address",address);
+		routingAlgorithm->SetAttribute("Address",address);
+	}
+
+	return routingAlgorithm;
+}
+
+void Isa100Helper::SetGraphRoute(uint32_t nodeInd, uint16_t graphId, std::vector<Mac16Address> nextHops)
+{
+	Ptr<NetDevice> baseDevice = m_devices.Get(nodeInd);
+	Ptr<Isa100NetDevice> netDevice = baseDevice->GetObject<Isa100NetDevice>();
+
+	if(!baseDevice || !netDevice)
+		NS_FATAL_ERROR("Installing routing graph on non-existent ISA100 net device.");
+
+	GetGraphRouting(netDevice)->SetGraph(graphId,nextHops);
+}
+
+void Isa100Helper::SetGraphDestination(uint32_t nodeInd, Mac16Address dest, uint16_t graphId)
+{
+	Ptr<NetDevice> baseDevice = m_devices.Get(nodeInd);
+	Ptr<Isa100NetDevice> netDevice = baseDevice->GetObject<Isa100NetDevice>();
+
+	if(!baseDevice || !netDevice)
+		NS_FATAL_ERROR("Installing routing graph on non-existent ISA100 net device.");
 
+	GetGraphRouting(netDevice)->SetDestinationGraph(dest,graphId);
 }
 
 void Isa100Helper::InstallBattery(uint32_t nodeIndex, Ptr<Isa100Battery> battery)
@@ -154,17 +247,17 @@ void Isa100Helper::InstallBattery(uint32_t nodeIndex, Ptr<Isa100Battery> battery
 
 	battery->SetDevicePointer(devPtr);
 
-  devPtr->GetPhy()->SetBatteryCallback( MakeCallback(&Isa100Battery::DecrementEnergy, battery) );
-  battery->SetConsumptionCategories(devPtr->GetPhy()->GetEnergyCategories());
+  devPtr->GetPhy()->SetBatteryCallback( MakeCallback(&Isa100Battery::SetPowerDraw, battery),
+  		battery->SetConsumptionCategories(devPtr->GetPhy()->GetEnergyCategories()) );
 
   if(devPtr->GetProcessor()){
-  	devPtr->GetProcessor()->SetBatteryCallback( MakeCallback(&Isa100Battery::DecrementEnergy, battery) );
-  	battery->SetConsumptionCategories(devPtr->GetProcessor()->GetEnergyCategories());
+  	devPtr->GetProcessor()->SetBatteryCallback( MakeCallback(&Isa100Battery::SetPowerDraw, battery),
+  			battery->SetConsumptionCategories(devPtr->GetProcessor()->GetEnergyCategories()) );
   }
 
   if(devPtr->GetSensor()){
-  	devPtr->GetSensor()->SetBatteryCallback( MakeCallback(&Isa100Battery::DecrementEnergy, battery) );
-  	battery->SetConsumptionCategories(devPtr->GetSensor()->GetEnergyCategories());
+  	devPtr->GetSensor()->SetBatteryCallback( MakeCallback(&Isa100Battery::SetPowerDraw, battery),
+  			battery->SetConsumptionCategories(devPtr->GetSensor()->GetEnergyCategories()) );
   }
 
   devPtr->SetBattery(battery);
@@ -184,8 +277,8 @@ void Isa100Helper::InstallProcessor(uint32_t nodeIndex, Ptr<Isa100Processor> pro
 	devPtr->GetDl()->SetProcessor(processor);
 
   if(devPtr->GetBattery()){
-  	processor->SetBatteryCallback( MakeCallback(&Isa100Battery::DecrementEnergy, devPtr->GetBattery()) );
-  	devPtr->GetBattery()->SetConsumptionCategories(processor->GetEnergyCategories());
+  	processor->SetBatteryCallback( MakeCallback(&Isa100Battery::SetPowerDraw, devPtr->GetBattery()),
+  			devPtr->GetBattery()->SetConsumptionCategories(processor->GetEnergyCategories()) );
   }
 
   devPtr->SetProcessor(processor);
@@ -203,8 +296,8 @@ void Isa100Helper::InstallSensor(uint32_t nodeIndex, Ptr<Isa100Sensor> sensor)
 		NS_FATAL_ERROR("Installing processor on a unconfigured net device or non-existent node.");
 
   if(devPtr->GetBattery()){
-  	sensor->SetBatteryCallback( MakeCallback(&Isa100Battery::DecrementEnergy, devPtr->GetBattery()) );
-  	devPtr->GetBattery()->SetConsumptionCategories(sensor->GetEnergyCategories());
+  	sensor->SetBatteryCallback( MakeCallback(&Isa100Battery::SetPowerDraw, devPtr->GetBattery()),
+  			devPtr->GetBattery()->SetConsumptionCategories(sensor->GetEnergyCategories()) );
   }
 
   devPtr->SetSensor(sensor);
@@ -24,12 +24,17 @@
 #define ISA100_HELPER_H
 
 #include "ns3/isa100-dl.h"
+#include "ns3/isa100-routing.h"
 #include "ns3/isa100-processor.h"
 #include "ns3/isa100-sensor.h"
 #include "ns3/net-device-container.h"
 #include "ns3/tdma-optimizer-base.h"
 #include "ns3/isa100-application.h"
 #include "ns3/vector.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+
+#include <deque>
 
 namespace ns3 {
 
@@ -117,6 +122,36 @@ public:
    */
   void SetSourceRoutingTable(uint32_t nodeInd, uint32_t numNodes,  std::string *routingTable);
 
+  /** Set the source route a specific node uses to reach a destination.
+   * - Must be called after Isa100Helper::Install()
+   * - Routes of all nodes are stored in one route table shared by the whole network.
+   *
+   * @param nodeInd Index of the node being configured.
+   * @param dest Final destination address.
+   * @param route Hop addresses from the first hop to the final destination.
+   */
+  void SetSourceRoute(uint32_t nodeInd, Mac16Address dest, const std::vector<Mac16Address> &route);
+
+  /** Set the next hops of a routing graph for a specific node.
+   * - Must be called after Isa100Helper::Install()
+   * - Installs an Isa100GraphRoutingAlgorithm on the node if it doesn't have one.
+   *
+   * @param nodeInd Index of the node being configured.
+   * @param graphId Graph ID.
+   * @param nextHops Next hop neighbours in order of preference, the rest are used as alternates when a transmission fails.
+   */
+  void SetGraphRoute(uint32_t nodeInd, uint16_t graphId, std::vector<Mac16Address> nextHops);
+
+  /** Set the graph a specific node uses to send packets to a destination.
+   * - Must be called after Isa100Helper::Install()
+   * - Installs an Isa100GraphRoutingAlgorithm on the node if it doesn't have one.
+   *
+   * @param nodeInd Index of the node being configured.
+   * @param dest Final destination address.
+   * @param graphId Graph ID.
+   */
+  void SetGraphDestination(uint32_t nodeInd, Mac16Address dest, uint16_t graphId);
+
   /** Install an application object on a specific node.
    * - Must be called after Isa100Helper::Install()
    *
@@ -216,6 +251,21 @@ public:
    */
   void SetSfSchedule(uint32_t nodeInd, uint8_t *hopPattern, uint32_t numHop, uint16_t *linkSched, DlLinkType *linkTypes, uint32_t numLink);
 
+  /** Add a superframe that runs concurrently with the one set by SetSfSchedule().
+   * - Must be called after Isa100Helper::Install() and before the DL starts.
+   *
+   * @param nodeInd Index of the node being configured.
+   * @param hopPattern Pointer to the array containing hop pattern channel numbers.
+   * @param numHop Length of hop pattern array.
+   * @param linkSched Pointer to the array indicating which superframe slots this node is active in.
+   * @param linkTypes Pointer to array indicating what kind of activity occurs in the active slots (TRANSMIT,RECEIVE,SHARED).
+   * @param numLink Length of the linkSched and linkTypes arrays.
+   * @param period Number of timeslots in the superframe.
+   * @param priority Superframe priority, the higher priority superframe keeps a slot both superframes use.
+   */
+  void AddSfSchedule(uint32_t nodeInd, uint8_t *hopPattern, uint32_t numHop, uint16_t *linkSched, DlLinkType *linkTypes, uint32_t numLink,
+  		uint16_t period, uint8_t priority);
+
 
   /** Pass a TDMA Optimizer attribute to the helper
    *  - used to configure attributes for TDMA Optimizers
@@ -241,10 +291,73 @@ public:
       Ptr<OutputStreamWrapper> stream = NULL);
 
 
+  // ------ Energy Tracing -----------
+
+  /** Write one energy record per node per interval instead of one per energy decrement.
+   * - Must be called after the batteries have been installed.
+   * - Enables AggregateEnergyTrace on every battery and connects its AggregatedEnergyConsumption
+   *   trace to the stream.  The interval is set by the battery EnergyTraceInterval attribute
+   *   (one record per superframe by default).
+   * - A category table is written for each node first, followed by the records.
+   * - Each record covers the interval from its start time to its end time.
+   * - Text format:  "Categories,<addr>,StartNs,EndNs,Address,EnergyLeft,<name 0>,<name 1>,..." then
+   *   "<start ns>,<end ns>,<addr>,<energy left>,<category 0 uJ>,<category 1 uJ>,..."
+   * - Binary format (native byte order): the category table is
+   *   { uint8 0, uint8 addr[2], uint16 n, n x { uint8 len, char name[len] } }
+   *   and each record is { uint8 1, uint8 addr[2], int64 start ns, int64 end ns, double energy left, uint16 n, double category[n] }.
+   *
+   * @param stream Output stream (must be opened in binary mode if binary is true).
+   * @param binary Write binary records instead of text.
+   */
+  void EnableAggregatedEnergyTrace(Ptr<OutputStreamWrapper> stream, bool binary);
+
+
+  // ------ Lifetime Fast Forward -----------
+
+  /** Estimate the network lifetime from the steady state energy consumption of the nodes.
+   * - Must be called after the batteries and superframe schedules have been installed.
+   * - The energy left in every battery is sampled once per superframe.  Once the energy consumed
+   *   per superframe by every node has stayed within FastForwardTolerance of its mean for
+   *   FastForwardFrames superframes, the time of the first battery depletion is extrapolated.
+   * - The estimate and its error bound are reported by the LifetimeEstimate trace source.
+   * - Only valid for dedicated slot TDMA schedules since contention in SHARED slots does not
+   *   reach a steady state.
+   *
+   * @param resume If false, the simulation is stopped once the lifetime is estimated.  If true,
+   *               the batteries are drained to FastForwardResumeFrames superframes before the first
+   *               depletion and the simulation continues (see GetFastForwardTime()).
+   * @param samplePeriod Time between energy samples.  Zero uses the time the merged superframe timeline
+   *                     of the DLs takes to repeat (Isa100Dl::GetTimelinePeriod()).
+   */
+  void EnableLifetimeFastForward(bool resume, Time samplePeriod = Seconds(0));
+
+  /** Get the extrapolated network lifetime.
+   *
+   * @return Lifetime (s) or -1 if the energy consumption has not yet converged.
+   */
+  double GetLifetimeEstimate() const;
+
+  /** Get the error bound of the extrapolated network lifetime.
+   *
+   * @return Maximum absolute error of GetLifetimeEstimate() (s).
+   */
+  double GetLifetimeErrorBound() const;
+
+  /** Get the amount of simulation time that was skipped by draining the batteries.
+   * - Must be added to the simulation time to get the true time of later events.
+   *
+   * @return Skipped time.
+   */
+  Time GetFastForwardTime() const;
+
   /**}@*/
 
 private:
 
+  /** Sample the battery energies and extrapolate the lifetime once the consumption has converged.
+   */
+  void SampleLifetimeEnergy();
+
   // -- Flow Matrix Scheduling Functions --
 
   // ... General Functions ...
@@ -326,13 +439,13 @@ private:
 
   // ... Source Routing List Generation ...
 
-  /** Determines source routing strings based on a packet flow matrix.
+  /** Determines source routes to the sink based on a packet flow matrix.
    *
-   * @param routingStrings Vector of routing strings.
+   * @param routes Vector of routes indexed by node, each a list of hop addresses ending at the sink.  Nodes without a route are left empty.
    * @param schedule TDMA schedule summary.
    * @return Whether routes could be found for all nodes.
    */
-  SchedulingResult CalculateSourceRouteStrings(vector<std::string> &routingStrings, vector< vector<int> > schedule);
+  SchedulingResult CalculateSourceRoutes(vector< vector<Mac16Address> > &routes, const vector< vector<int> > &schedule);
 
 
 
@@ -361,10 +474,29 @@ private:
   NetDeviceContainer m_devices;  ///< Contains the devices being set up.
 
   double **m_txPwrDbm; /// Holds transmit powers between nodes.
+  Ptr<Isa100SourceRouteTable> m_sourceRouteTable; ///< Source routes shared by all nodes.
   int m_numTimeslots; ///< Number of timeslots in a superframe.
 
   HelperLocationTracedCallback m_locationTrace;
 
+  // Lifetime fast forward
+  bool m_ffResume;  ///< Continue the simulation after draining the batteries.
+  Time m_ffSamplePeriod;  ///< Time between battery energy samples.
+  double m_ffTolerance;  ///< Max relative deviation of the per-superframe consumption from its mean.
+  uint32_t m_ffFrames;  ///< Number of superframes the consumption must be stable for.
+  uint32_t m_ffResumeFrames;  ///< Number of superframes left before depletion when the simulation resumes.
+  std::vector<double> m_ffLastEnergy;  ///< Energy of each node at the last sample (uJ).
+  std::vector< std::deque<double> > m_ffDeltas;  ///< Most recent per-superframe consumption of each node (uJ).
+  EventId m_ffEvent;  ///< Next sampling event.
+  double m_lifetimeEstimate;  ///< Extrapolated network lifetime (s).
+  double m_lifetimeErrorBound;  ///< Error bound of the lifetime estimate (s).
+  Time m_ffSkippedTime;  ///< Simulation time skipped by draining the batteries.
+
+  /** Trace source for the extrapolated lifetime.
+   * - Lifetime (s), error bound (s), address of the first node to deplete.
+   */
+  TracedCallback<double, double, Mac16Address> m_lifetimeTrace;
+
 
 };
 
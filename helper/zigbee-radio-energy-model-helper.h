@@ -1,124 +0,0 @@
-/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
-/*
- * Copyright (c) 2016 The University Of Calgary- FISHLAB
- *
- * This program is free software; you can redistribute it and/or modify
- * it under the terms of the GNU General Public License version 2 as
- * published by the Free Software Foundation;
- *
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with this program; if not, write to the Free Software
- * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
- *
- * Author:   Michael Herrmann <mjherrma@ucalgary.ca>
- */
-
-#ifndef ZIGBEE_RADIO_ENERGY_MODEL_HELPER_H
-#define ZIGBEE_RADIO_ENERGY_MODEL_HELPER_H
-
-#include "ns3/energy-model-helper.h"
-#include "ns3/zigbee-radio-energy-model.h"
-
-namespace ns3 {
-
-/**
- * \ingroup energy
- * \brief Assign ZigbeeRadioEnergyModel to zigbee devices.
- *
- * This installer installs ZigbeeRadioEnergyModel for only Isa100NetDevice objects.
- *
- */
-class ZigbeeRadioEnergyModelHelper : public DeviceEnergyModelHelper
-{
-public:
-  /**
-   * Construct a helper which is used to add a radio energy model to a node
-   */
-  ZigbeeRadioEnergyModelHelper ();
-
-  /**
-   * Destroy a RadioEnergy Helper
-   */
-  ~ZigbeeRadioEnergyModelHelper ();
-
-  /**
-   * Sets an attribute of the underlying PHY object.
-   *
-   * \param name the name of the attribute to set
-   * \param v the value of the attribute
-   */
-  void Set (std::string name, const AttributeValue &v);
-
-  /**
-   * Sets the callback to be invoked when energy is depleted.
-   *
-   * \param callback Callback function for energy depletion handling.
-   */
-  void SetDepletionCallback (
-    ZigbeeRadioEnergyModel::ZigbeeRadioEnergyDepletionCallback callback);
-
-  /**
-   * Sets the callback to be invoked when energy is recharged.
-   *
-   * \param callback Callback function for energy recharged handling.
-   */
-  void SetRechargedCallback (
-    ZigbeeRadioEnergyModel::ZigbeeRadioEnergyRechargedCallback callback);
-
-  /**
-   * \param name the name of the model to set
-   * \param n0 the name of the attribute to set
-   * \param v0 the value of the attribute to set
-   * \param n1 the name of the attribute to set
-   * \param v1 the value of the attribute to set
-   * \param n2 the name of the attribute to set
-   * \param v2 the value of the attribute to set
-   * \param n3 the name of the attribute to set
-   * \param v3 the value of the attribute to set
-   * \param n4 the name of the attribute to set
-   * \param v4 the value of the attribute to set
-   * \param n5 the name of the attribute to set
-   * \param v5 the value of the attribute to set
-   * \param n6 the name of the attribute to set
-   * \param v6 the value of the attribute to set
-   * \param n7 the name of the attribute to set
-   * \param v7 the value of the attribute to set
-   *
-   * Configure a Transmission Current model for this EnergySource.
-   */
-  void SetTxCurrentModel (std::string name,
-                          std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
-                          std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
-                          std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
-                          std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue (),
-                          std::string n4 = "", const AttributeValue &v4 = EmptyAttributeValue (),
-                          std::string n5 = "", const AttributeValue &v5 = EmptyAttributeValue (),
-                          std::string n6 = "", const AttributeValue &v6 = EmptyAttributeValue (),
-                          std::string n7 = "", const AttributeValue &v7 = EmptyAttributeValue ());
-
-private:
-  /**
-   * Implements DeviceEnergyModel::Install.
-   *
-   * @param device Pointer to the NetDevice to install DeviceEnergyModel.
-   * @param source Pointer to EnergySource to install.
-   */
-  virtual Ptr<DeviceEnergyModel> DoInstall (Ptr<NetDevice> device,
-                                            Ptr<EnergySource> source) const;
-
-private:
-  ObjectFactory m_radioEnergy;
-  ZigbeeRadioEnergyModel::ZigbeeRadioEnergyDepletionCallback m_depletionCallback;
-  ZigbeeRadioEnergyModel::ZigbeeRadioEnergyRechargedCallback m_rechargedCallback;
-  ObjectFactory m_txCurrentModel;
-
-};
-
-} // namespace ns3
-
-#endif /* ZIGBEE_RADIO_ENERGY_MODEL_HELPER_H */
@@ -19,6 +19,13 @@
  */
 
 #include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "fish-propagation-loss-model.h"
 
 #include "ns3/log.h"
@@ -98,64 +105,157 @@ FishCustomLossModel::GetTypeId (void)
 FishCustomLossModel::FishCustomLossModel ()
 {
   m_lookupTableDb = 0;
+  m_mappedFile = 0;
+  m_mappedLength = 0;
 }
 
 FishCustomLossModel::FishCustomLossModel (std::vector<Vector> mapPosToIndex, double **lookupTable)
 {
+  m_mappedFile = 0;
+  m_mappedLength = 0;
+
   m_mapPosToIndex = mapPosToIndex;
-  uint16_t numNodes = m_mapPosToIndex.size();
+  uint32_t numNodes = m_mapPosToIndex.size();
 
-  m_lookupTableDb = new double*[numNodes];
-  for(uint16_t i = 0; i < numNodes; i++)
+  m_lookupTableStorage.resize((size_t)numNodes * numNodes);
+  for(uint32_t i = 0; i < numNodes; i++)
   {
-    m_lookupTableDb[i] = new double[numNodes];
-    memcpy(m_lookupTableDb[i], lookupTable[i], numNodes * sizeof(double));
+    memcpy(&m_lookupTableStorage[(size_t)i * numNodes], lookupTable[i], numNodes * sizeof(double));
   }
+  m_lookupTableDb = numNodes ? &m_lookupTableStorage[0] : 0;
+
+  IndexPositions();
 }
 
 FishCustomLossModel::~FishCustomLossModel ()
 {
-  for(uint16_t i = 0; i < m_mapPosToIndex.size(); i++){
-    delete[] m_lookupTableDb[i];
+  UnmapLookupTable();
+}
+
+void
+FishCustomLossModel::IndexPositions (void)
+{
+  m_positionIndex.clear();
+  m_mobilityIndex.clear();
+
+  for (uint32_t i = 0; i < m_mapPosToIndex.size(); i++)
+  {
+    Vector pos = m_mapPosToIndex[i];
+    m_positionIndex[PositionKey(pos.x, std::make_pair(pos.y, pos.z))] = i;
   }
 }
 
+void
+FishCustomLossModel::UnmapLookupTable (void)
+{
+  if (m_mappedFile)
+  {
+    munmap(m_mappedFile, m_mappedLength);
+    m_mappedFile = 0;
+    m_mappedLength = 0;
+  }
+}
 
-double
-FishCustomLossModel::DoCalcRxPower (double txPowerDbm,
-                                                Ptr<MobilityModel> a,
-                                                Ptr<MobilityModel> b) const
+void
+FishCustomLossModel::LoadLookupTable (std::string fileName)
 {
-  if (m_lookupTableDb == 0){
-    NS_FATAL_ERROR("CustomPropogationLossModel: Lookup table was not initialized!");
+  NS_LOG_FUNCTION (this << fileName);
+
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0)
+    NS_FATAL_ERROR("CustomPropogationLossModel: Could not open lookup table file " << fileName);
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) < 0 || fileStat.st_size < (off_t)(2 * sizeof(uint32_t)))
+  {
+    close(fd);
+    NS_FATAL_ERROR("CustomPropogationLossModel: Lookup table file " << fileName << " is too short!");
   }
 
-  // Have to determine the indices from the positions
-  uint16_t indexA = 0xFFFF;
-  uint16_t indexB = 0xFFFF;
-  std::vector<Vector>::const_iterator iter;
+  void *mapped = mmap(0, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED)
+    NS_FATAL_ERROR("CustomPropogationLossModel: Could not memory map " << fileName);
 
-  // Find indices
-  for (iter = m_mapPosToIndex.begin(); iter != m_mapPosToIndex.end(); ++iter)
+  uint32_t numNodes = *(const uint32_t *)mapped;
+  const double *positions = (const double *)((const uint8_t *)mapped + 2 * sizeof(uint32_t));
+  size_t expectedSize = 2 * sizeof(uint32_t) + (3 * (size_t)numNodes + (size_t)numNodes * numNodes) * sizeof(double);
+  if ((size_t)fileStat.st_size != expectedSize)
   {
-    if (CalculateDistance(*iter, a->GetPosition()) == 0)
-    {
-      indexA = iter - m_mapPosToIndex.begin();
-    }
+    munmap(mapped, fileStat.st_size);
+    NS_FATAL_ERROR("CustomPropogationLossModel: Lookup table file " << fileName << " has the wrong size for " << numNodes << " nodes!");
+  }
 
-    if (CalculateDistance(*iter, b->GetPosition()) == 0)
-    {
-      indexB = iter - m_mapPosToIndex.begin();
-    }
+  UnmapLookupTable();
+  m_lookupTableStorage.clear();
+  m_mappedFile = mapped;
+  m_mappedLength = fileStat.st_size;
+
+  m_mapPosToIndex.clear();
+  for (uint32_t i = 0; i < numNodes; i++)
+  {
+    m_mapPosToIndex.push_back(Vector(positions[3*i], positions[3*i+1], positions[3*i+2]));
   }
+  m_lookupTableDb = positions + 3 * (size_t)numNodes;
+
+  IndexPositions();
+}
 
-  // Check if valid indices were found
-  if (indexA == 0xFFFF || indexB == 0xFFFF){
+void
+FishCustomLossModel::SaveLookupTable (std::string fileName, std::vector<Vector> mapPosToIndex, double **lookupTableDb)
+{
+  std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+  if (!file.is_open())
+    NS_FATAL_ERROR("CustomPropogationLossModel: Could not create lookup table file " << fileName);
+
+  uint32_t header[2] = { (uint32_t)mapPosToIndex.size(), 0 };
+  file.write((const char *)header, sizeof(header));
+
+  for (uint32_t i = 0; i < mapPosToIndex.size(); i++)
+  {
+    double pos[3] = { mapPosToIndex[i].x, mapPosToIndex[i].y, mapPosToIndex[i].z };
+    file.write((const char *)pos, sizeof(pos));
+  }
+
+  for (uint32_t i = 0; i < mapPosToIndex.size(); i++)
+  {
+    file.write((const char *)lookupTableDb[i], mapPosToIndex.size() * sizeof(double));
+  }
+
+  file.close();
+}
+
+uint32_t
+FishCustomLossModel::GetNodeIndex (Ptr<MobilityModel> m) const
+{
+  std::map<const MobilityModel*, uint32_t>::const_iterator it = m_mobilityIndex.find(PeekPointer(m));
+  if (it != m_mobilityIndex.end())
+    return it->second;
+
+  Vector pos = m->GetPosition();
+  std::map<PositionKey, uint32_t>::const_iterator posIt = m_positionIndex.find(PositionKey(pos.x, std::make_pair(pos.y, pos.z)));
+
+  // Check if a valid index was found
+  if (posIt == m_positionIndex.end()){
     NS_FATAL_ERROR("CustomPropogationLossModel: Valid indices used for lookup could not be found!");
   }
 
+  m_mobilityIndex[PeekPointer(m)] = posIt->second;
+  return posIt->second;
+}
+
+
+double
+FishCustomLossModel::DoCalcRxPower (double txPowerDbm,
+                                                Ptr<MobilityModel> a,
+                                                Ptr<MobilityModel> b) const
+{
+  if (m_lookupTableDb == 0){
+    NS_FATAL_ERROR("CustomPropogationLossModel: Lookup table was not initialized!");
+  }
+
   // Look up path loss
-  double pathlossDb = m_lookupTableDb[indexA][indexB];
+  double pathlossDb = m_lookupTableDb[(size_t)GetNodeIndex(a) * m_mapPosToIndex.size() + GetNodeIndex(b)];
 
   // Calculate and return receive power
   return txPowerDbm - pathlossDb;
@@ -231,39 +331,62 @@ void FishLogDistanceLossModel::GenerateNewShadowingValues (Ptr<ListPositionAlloc
   m_isStationary = true;
 
   // Create position vector to index map
-  std::vector<Vector> posVect;
+  m_nodePositions.clear();
   for (uint16_t i = 0; i < numNodes; i++)
   {
-    posVect.push_back(positionAlloc->GetNext());
+    m_nodePositions.push_back(positionAlloc->GetNext());
   }
 
-  m_shadowingLookup.clear();
+  m_mobilityIndex.clear();
 
-  // Generate the lookup map for shadowing values
-  for (uint16_t i = 0; i < numNodes; i++)
+  // Generate the upper triangle of the shadowing table (fading is the same for both directions of a link)
+  m_shadowingTable.assign((uint64_t)numNodes * (numNodes - 1) / 2, 0.0);
+  for (uint32_t i = 0; i < numNodes; i++)
   {
-    for (uint16_t j = i + 1; j < numNodes; j++)
+    for (uint32_t j = i + 1; j < numNodes; j++)
     {
-      // Create lookup keys (fading is the same for both directions of a link)
-      std::stringstream key1, key2;
-      key1 << (int32_t)posVect[i].x << (int32_t)posVect[i].y << (int32_t)posVect[i].z
-          << (int32_t)posVect[j].x << (int32_t)posVect[j].y << (int32_t)posVect[j].z;
-      key2 << (int32_t)posVect[j].x << (int32_t)posVect[j].y << (int32_t)posVect[j].z
-          << (int32_t)posVect[i].x << (int32_t)posVect[i].y << (int32_t)posVect[i].z;
-
       // Shadowing Value
       double shadowingDb = m_normDist->GetValue();
 
-      NS_LOG_DEBUG(" " << key1.str() << " to " << key2.str() << ": " << shadowingDb << "dB");
+      NS_LOG_DEBUG(" " << i << " to " << j << ": " << shadowingDb << "dB");
 
-      // Record values
-      m_shadowingLookup[key1.str()] = shadowingDb;
-      m_shadowingLookup[key2.str()] = shadowingDb;
+      m_shadowingTable[GetTableOffset(i,j)] = shadowingDb;
     }
   }
 }
 
+uint64_t
+FishLogDistanceLossModel::GetTableOffset (uint32_t i, uint32_t j) const
+{
+  NS_ASSERT (i != j);
+  if (i > j)
+    std::swap (i, j);
+
+  // Row i of the upper triangle starts after the (n-1) + (n-2) + ... + (n-i) entries of the previous rows.
+  uint64_t n = m_nodePositions.size();
+  return (uint64_t)i * (2 * n - i - 1) / 2 + (j - i - 1);
+}
+
+uint32_t
+FishLogDistanceLossModel::GetNodeIndex (Ptr<MobilityModel> m) const
+{
+  std::map<const MobilityModel*, uint32_t>::const_iterator it = m_mobilityIndex.find(PeekPointer(m));
+  if (it != m_mobilityIndex.end())
+    return it->second;
+
+  Vector pos = m->GetPosition();
+  for (uint32_t i = 0; i < m_nodePositions.size(); i++)
+  {
+    if (CalculateDistance(m_nodePositions[i], pos) == 0)
+    {
+      m_mobilityIndex[PeekPointer(m)] = i;
+      return i;
+    }
+  }
 
+  NS_FATAL_ERROR("Prop Model could not find shadowing value!");
+  return 0;
+}
 
 
 
@@ -297,14 +420,7 @@ FishLogDistanceLossModel::DoCalcRxPower (double txPowerDbm,
   double shadowingDb;
   if (m_isStationary)
   {
-    std::stringstream key;
-    key << (int32_t)a->GetPosition().x << (int32_t)a->GetPosition().y << (int32_t)a->GetPosition().z
-        << (int32_t)b->GetPosition().x << (int32_t)b->GetPosition().y << (int32_t)b->GetPosition().z;
-
-
-    std::map<std::string, double>::const_iterator it = m_shadowingLookup.find(key.str());
-    NS_ASSERT_MSG(it != m_shadowingLookup.end(), "Prop Model could not find shadowing value!");
-    shadowingDb = it->second;
+    shadowingDb = m_shadowingTable[GetTableOffset(GetNodeIndex(a), GetNodeIndex(b))];
   }
 
   else {
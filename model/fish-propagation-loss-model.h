@@ -5,6 +5,9 @@
 #include "ns3/position-allocator.h"
 #include "ns3/boolean.h"
 
+#include <map>
+#include <vector>
+
 namespace ns3 {
 
 
@@ -71,6 +74,13 @@ private:
  *
  * There are no additional loss calculations done, the
  * loss in the lookupTable is the total link loss
+ *
+ * The table is stored as a single row-major matrix.  Large tables can be
+ * memory mapped from a binary file created by SaveLookupTable() rather than
+ * being copied into memory.  The file layout is:
+ *  - uint32_t number of nodes (N) followed by 4 bytes of padding
+ *  - N node positions, each as 3 doubles (x, y, z)
+ *  - N x N doubles of link loss (dB), row-major
  */
 class FishCustomLossModel : public PropagationLossModel
 {
@@ -86,6 +96,21 @@ public:
 
   ~FishCustomLossModel ();
 
+  /** Memory map a lookup table from a binary file.
+   * - Replaces any table that is already loaded.
+   *
+   * @param fileName Name of the file created by SaveLookupTable().
+   */
+  void LoadLookupTable (std::string fileName);
+
+  /** Write a lookup table to a binary file that can be loaded with LoadLookupTable().
+   *
+   * @param fileName Name of the file to create.
+   * @param mapPosToIndex Node positions.
+   * @param lookupTableDb Link loss (dB) between each pair of nodes.
+   */
+  static void SaveLookupTable (std::string fileName, std::vector<Vector> mapPosToIndex, double **lookupTableDb);
+
 private:
   /**
    * \brief Copy constructor
@@ -107,8 +132,32 @@ private:
 
   virtual int64_t DoAssignStreams (int64_t stream);
 
+  /** Build the position to index map from m_mapPosToIndex.
+   */
+  void IndexPositions (void);
+
+  /** Release the memory mapped file, if any.
+   */
+  void UnmapLookupTable (void);
+
+  /** Get the lookup table index of the node using a mobility model.
+   * - The position is only hashed the first time the mobility model is seen.  After that the index is
+   *   found by the mobility model pointer alone, nothing is queried from the model or its node.
+   *
+   * @param m Mobility model of the node.
+   * @return Index of the node in the lookup table.
+   */
+  uint32_t GetNodeIndex (Ptr<MobilityModel> m) const;
+
+  typedef std::pair<double, std::pair<double, double> > PositionKey;
+
   std::vector<Vector> m_mapPosToIndex;    //!< Maps the node positions to an index for the lookup table
-  double  **m_lookupTableDb;              //!< Lookup table for all path loss exponents between nodes
+  std::map<PositionKey, uint32_t> m_positionIndex;  //!< Node position to lookup table index
+  mutable std::map<const MobilityModel*, uint32_t> m_mobilityIndex;  //!< Mobility model to lookup table index
+  std::vector<double> m_lookupTableStorage;  //!< Row-major storage when the table is copied into memory
+  const double *m_lookupTableDb;          //!< Lookup table for all path loss exponents between nodes (row-major)
+  void *m_mappedFile;                     //!< Start of the memory mapped table file
+  size_t m_mappedLength;                  //!< Length of the memory mapped table file (bytes)
 };
 
 /**
@@ -132,6 +181,12 @@ private:
  *
  * The model also allows for shadowing to be included in the path loss.
  *
+ * For stationary networks the shadowing of each link is drawn once and stored in a
+ * triangular table indexed by node (links are symmetric).  Mobility models are mapped
+ * to node indices the first time they are seen so each subsequent reception costs a
+ * single table load.  The table uses single precision to keep memory bounded
+ * (about 50 MB for 5000 nodes).
+ *
  */
 class FishLogDistanceLossModel : public PropagationLossModel
 {
@@ -183,6 +238,23 @@ private:
    */
   static Ptr<PropagationLossModel> CreateDefaultReference (void);
 
+  /** Get the index of the node using a mobility model.
+   * - The index is found by matching the node position the first time the mobility model is seen.  After
+   *   that it is found by the mobility model pointer alone, nothing is queried from the model or its node.
+   *
+   * @param m Mobility model of the node.
+   * @return Index of the node in the shadowing table.
+   */
+  uint32_t GetNodeIndex (Ptr<MobilityModel> m) const;
+
+  /** Get the position in the triangular shadowing table of the link between two nodes.
+   *
+   * @param i Index of the first node.
+   * @param j Index of the second node (must not equal i).
+   * @return Offset into m_shadowingTable.
+   */
+  uint64_t GetTableOffset (uint32_t i, uint32_t j) const;
+
   double m_exponent; //!< model exponent
   double m_referenceDistance; //!< reference distance
   double m_referenceLoss; //!< reference loss
@@ -190,7 +262,9 @@ private:
   bool m_isStationary;  ///< Indicates if the network is stationary or not
 
   Ptr<NormalRandomVariable> m_normDist; ///< the normal distribution used for shadowing
-  std::map<std::string, double> m_shadowingLookup; ///< Used for stationary networks to store the shadowing gain
+  std::vector<Vector> m_nodePositions;  ///< Position of each node in the shadowing table.
+  std::vector<float> m_shadowingTable;  ///< Used for stationary networks to store the shadowing gain (dB), upper triangle only.
+  mutable std::map<const MobilityModel*, uint32_t> m_mobilityIndex; ///< Maps mobility models to node indices.
 };
 
 
@@ -0,0 +1,490 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 The University Of Calgary- FISHLAB
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/fish-spectrum-channel.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/antenna-model.h"
+#include "ns3/angles.h"
+#include "ns3/spectrum-phy.h"
+
+#include <algorithm>
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("FishSpectrumChannel");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (FishSpectrumChannel);
+
+static bool
+CompareNeighborThreshold (const FishSpectrumChannelNeighbor &a, const FishSpectrumChannelNeighbor &b)
+{
+  return a.m_minTxPower < b.m_minTxPower;
+}
+
+TypeId
+FishSpectrumChannel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FishSpectrumChannel")
+    .SetParent<SingleModelSpectrumChannel> ()
+    .AddConstructor<FishSpectrumChannel> ()
+    .AddAttribute ("ReceiverCulling",
+                   "Only deliver signals to receivers that can hear them.  Requires a stationary network.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&FishSpectrumChannel::m_cullReceivers),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ChannelPartitioning",
+                   "Only deliver signals to receivers tuned to a band occupied by the signal.  "
+                   "Receivers hopping into a band are handed the rest of the signals already on it.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&FishSpectrumChannel::m_partitionByBand),
+                   MakeBooleanChecker ())
+    .AddAttribute ("DefaultNoiseFloorDbm",
+                   "Noise floor (dBm) used for culling receivers that do not have a NoiseFloorDbm attribute.",
+                   DoubleValue (-120.0),
+                   MakeDoubleAccessor (&FishSpectrumChannel::m_defaultNoiseFloorDbm),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("CullingMarginDb",
+                   "Signals are only culled if they arrive this far (dB) below the receiver noise floor.  "
+                   "Culled signals don't add to the receiver interference.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&FishSpectrumChannel::m_cullingMarginDb),
+                   MakeDoubleChecker<double> (0.0))
+  ;
+  return tid;
+}
+
+FishSpectrumChannel::FishSpectrumChannel ()
+{
+  NS_LOG_FUNCTION (this);
+  m_cullReceivers = true;
+  m_partitionByBand = true;
+  m_bandMembers.resize (1);
+  m_defaultNoiseFloorDbm = -120.0;
+  m_cullingMarginDb = 0.0;
+}
+
+FishSpectrumChannel::~FishSpectrumChannel ()
+{
+}
+
+void
+FishSpectrumChannel::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+  m_rxPhys.clear ();
+  m_rxIndex.clear ();
+  m_rxBand.clear ();
+  m_bandMembers.clear ();
+  m_rxPosInBand.clear ();
+  m_neighbors.clear ();
+  m_trackedMobility.clear ();
+  m_activeSignals.clear ();
+  m_propagationLoss = 0;
+  m_spectrumPropagationLoss = 0;
+  m_propagationDelay = 0;
+  SingleModelSpectrumChannel::DoDispose ();
+}
+
+void
+FishSpectrumChannel::AddPropagationLossModel (Ptr<PropagationLossModel> loss)
+{
+  NS_LOG_FUNCTION (this << loss);
+  SingleModelSpectrumChannel::AddPropagationLossModel (loss);
+  m_propagationLoss = loss;
+  InvalidateNeighbors ();
+}
+
+void
+FishSpectrumChannel::AddSpectrumPropagationLossModel (Ptr<SpectrumPropagationLossModel> loss)
+{
+  NS_LOG_FUNCTION (this << loss);
+  SingleModelSpectrumChannel::AddSpectrumPropagationLossModel (loss);
+  m_spectrumPropagationLoss = loss;
+}
+
+void
+FishSpectrumChannel::SetPropagationDelayModel (Ptr<PropagationDelayModel> delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  SingleModelSpectrumChannel::SetPropagationDelayModel (delay);
+  m_propagationDelay = delay;
+}
+
+void
+FishSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  SingleModelSpectrumChannel::AddRx (phy);
+
+  // Receive all bands until the PHY reports the band it is tuned to.
+  uint32_t rxIndex = m_rxPhys.size ();
+  m_rxPhys.push_back (phy);
+  m_rxIndex[PeekPointer (phy)] = rxIndex;
+  m_rxBand.push_back (-1);
+  m_rxPosInBand.push_back (m_bandMembers[0].size ());
+  m_bandMembers[0].push_back (rxIndex);
+
+  InvalidateNeighbors ();
+}
+
+std::vector<Ptr<SpectrumSignalParameters> >
+FishSpectrumChannel::SetRxBand (Ptr<const SpectrumPhy> phy, int32_t band)
+{
+  NS_LOG_FUNCTION (this << phy << band);
+
+  std::vector<Ptr<SpectrumSignalParameters> > missed;
+
+  std::map<const SpectrumPhy*, uint32_t>::const_iterator it = m_rxIndex.find (PeekPointer (phy));
+  if (it == m_rxIndex.end ())
+    {
+      NS_LOG_LOGIC (" PHY " << phy << " is not attached to the channel, ignoring band change.");
+      return missed;
+    }
+
+  uint32_t rxIndex = it->second;
+  int32_t oldBand = m_rxBand[rxIndex];
+  if (oldBand == band)
+    {
+      return missed;
+    }
+
+  // Hand over the rest of the signals in the new band that weren't delivered in the old one.
+  // A receiver of all bands (-1) already has every signal.
+  if (m_partitionByBand && oldBand >= 0)
+    {
+      Ptr<SpectrumPhy> rxPhy = m_rxPhys[rxIndex];
+      Ptr<MobilityModel> rxMobility = rxPhy->GetMobility ();
+      Time now = Simulator::Now ();
+
+      for (uint32_t i = 0; i < m_activeSignals.size (); i++)
+        {
+          const FishSpectrumChannelActiveSignal &signal = m_activeSignals[i];
+          const SpectrumValue &psd = *signal.m_params->psd;
+
+          if (signal.m_end <= now || signal.m_params->txPhy == rxPhy
+              || !OccupiesBand (psd, band) || OccupiesBand (psd, oldBand))
+            {
+              continue;
+            }
+
+          Ptr<MobilityModel> txMobility = signal.m_params->txPhy->GetMobility ();
+          double gainDb = CalculateGainDb (signal.m_params->txPhy, txMobility, rxPhy, rxMobility);
+
+          Ptr<SpectrumSignalParameters> rxParams = signal.m_params->Copy ();
+          *(rxParams->psd) *= std::pow (10.0, gainDb / 10.0);
+          if (m_spectrumPropagationLoss)
+            {
+              rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, rxMobility);
+            }
+          rxParams->duration = signal.m_end - now;
+          missed.push_back (rxParams);
+        }
+
+      NS_LOG_LOGIC (" Handing " << missed.size () << " signals already on band " << band << " to the receiver.");
+    }
+
+  // Swap the receiver out of its current band list.
+  std::vector<uint32_t> &oldMembers = m_bandMembers[oldBand + 1];
+  uint32_t pos = m_rxPosInBand[rxIndex];
+  oldMembers[pos] = oldMembers.back ();
+  m_rxPosInBand[oldMembers[pos]] = pos;
+  oldMembers.pop_back ();
+
+  if ((uint32_t)(band + 1) >= m_bandMembers.size ())
+    {
+      m_bandMembers.resize (band + 2);
+    }
+
+  std::vector<uint32_t> &newMembers = m_bandMembers[band + 1];
+  m_rxPosInBand[rxIndex] = newMembers.size ();
+  newMembers.push_back (rxIndex);
+  m_rxBand[rxIndex] = band;
+
+  return missed;
+}
+
+bool
+FishSpectrumChannel::OccupiesBand (const SpectrumValue &psd, int32_t band)
+{
+  if (band < 0)
+    {
+      return true;
+    }
+  return (uint32_t)band < psd.GetSpectrumModel ()->GetNumBands () && *(psd.ConstValuesBegin () + band) != 0.0;
+}
+
+bool
+FishSpectrumChannel::IsTunedToSignal (const SpectrumValue &psd, uint32_t rxIndex) const
+{
+  return !m_partitionByBand || OccupiesBand (psd, m_rxBand[rxIndex]);
+}
+
+void
+FishSpectrumChannel::InvalidateNeighbors (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_neighbors.clear ();
+}
+
+void
+FishSpectrumChannel::TrackMobility (Ptr<MobilityModel> mobility)
+{
+  if (m_trackedMobility.find (PeekPointer (mobility)) != m_trackedMobility.end ())
+    {
+      return;
+    }
+
+  mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&FishSpectrumChannel::CourseChanged, this));
+  m_trackedMobility.insert (PeekPointer (mobility));
+}
+
+void
+FishSpectrumChannel::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  InvalidateNeighbors ();
+}
+
+const std::vector<FishSpectrumChannelNeighbor>&
+FishSpectrumChannel::GetNeighbors (Ptr<SpectrumPhy> txPhy)
+{
+  std::map<const SpectrumPhy*, std::vector<FishSpectrumChannelNeighbor> >::iterator it = m_neighbors.find (PeekPointer (txPhy));
+  if (it != m_neighbors.end ())
+    {
+      return it->second;
+    }
+
+  NS_LOG_FUNCTION (this << txPhy);
+
+  Ptr<MobilityModel> txMobility = txPhy->GetMobility ();
+  NS_ASSERT_MSG (txMobility, "FishSpectrumChannel: Transmitter has no mobility model.");
+  TrackMobility (txMobility);
+
+  std::vector<FishSpectrumChannelNeighbor> &neighbors = m_neighbors[PeekPointer (txPhy)];
+
+  for (uint32_t i = 0; i < m_rxPhys.size (); i++)
+    {
+      Ptr<SpectrumPhy> rxPhy = m_rxPhys[i];
+      if (rxPhy == txPhy)
+        {
+          continue;
+        }
+
+      Ptr<MobilityModel> rxMobility = rxPhy->GetMobility ();
+      NS_ASSERT_MSG (rxMobility, "FishSpectrumChannel: Receiver has no mobility model.");
+      TrackMobility (rxMobility);
+
+      double gainDb = CalculateGainDb (txPhy, txMobility, rxPhy, rxMobility);
+
+      DoubleValue noiseFloorDbm (m_defaultNoiseFloorDbm);
+      rxPhy->GetAttributeFailSafe ("NoiseFloorDbm", noiseFloorDbm);
+
+      FishSpectrumChannelNeighbor neighbor;
+      neighbor.m_phy = rxPhy;
+      neighbor.m_rxIndex = i;
+      neighbor.m_gain = std::pow (10.0, gainDb / 10.0);
+      neighbor.m_minTxPower = std::pow (10.0, (noiseFloorDbm.Get () - m_cullingMarginDb) / 10.0) / 1000.0 / neighbor.m_gain;
+      neighbors.push_back (neighbor);
+    }
+
+  std::sort (neighbors.begin (), neighbors.end (), CompareNeighborThreshold);
+
+  return neighbors;
+}
+
+double
+FishSpectrumChannel::CalculateGainDb (Ptr<SpectrumPhy> txPhy, Ptr<MobilityModel> txMobility,
+                                      Ptr<SpectrumPhy> rxPhy, Ptr<MobilityModel> rxMobility) const
+{
+  double gainDb = 0.0;
+  if (m_propagationLoss)
+    {
+      gainDb += m_propagationLoss->CalcRxPower (0.0, txMobility, rxMobility);
+    }
+
+  Ptr<AntennaModel> txAntenna = txPhy->GetRxAntenna ();
+  if (txAntenna)
+    {
+      gainDb += txAntenna->GetGainDb (Angles (rxMobility->GetPosition (), txMobility->GetPosition ()));
+    }
+  Ptr<AntennaModel> rxAntenna = rxPhy->GetRxAntenna ();
+  if (rxAntenna)
+    {
+      gainDb += rxAntenna->GetGainDb (Angles (txMobility->GetPosition (), rxMobility->GetPosition ()));
+    }
+
+  return gainDb;
+}
+
+void
+FishSpectrumChannel::ScheduleRx (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                                 Ptr<SpectrumPhy> rxPhy, double gain)
+{
+  Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+  *(rxParams->psd) *= gain;
+
+  Ptr<MobilityModel> rxMobility = rxPhy->GetMobility ();
+  if (m_spectrumPropagationLoss)
+    {
+      rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, rxMobility);
+    }
+
+  Time delay = MicroSeconds (0);
+  if (m_propagationDelay)
+    {
+      delay = m_propagationDelay->GetDelay (txMobility, rxMobility);
+    }
+
+  Ptr<NetDevice> netDev = rxPhy->GetDevice ();
+  if (netDev)
+    {
+      // the receiver has a NetDevice, so we expect that it is attached to a Node
+      uint32_t dstNode = netDev->GetNode ()->GetId ();
+      Simulator::ScheduleWithContext (dstNode, delay, &FishSpectrumChannel::DeliverRx, this, rxParams, rxPhy);
+    }
+  else
+    {
+      // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
+      Simulator::Schedule (delay, &FishSpectrumChannel::DeliverRx, this, rxParams, rxPhy);
+    }
+}
+
+void
+FishSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
+{
+  NS_LOG_FUNCTION (this << txParams);
+
+  NS_ASSERT_MSG (txParams->psd, "NULL txPsd");
+  NS_ASSERT_MSG (txParams->txPhy, "NULL txPhy");
+
+  // Keep the signal until it leaves the medium so receivers hopping into its band can be given
+  // the rest of it.  Signals that have ended are dropped here since few are ever on the medium.
+  if (m_partitionByBand)
+    {
+      Time now = Simulator::Now ();
+      for (uint32_t i = 0; i < m_activeSignals.size (); )
+        {
+          if (m_activeSignals[i].m_end <= now)
+            {
+              m_activeSignals[i] = m_activeSignals.back ();
+              m_activeSignals.pop_back ();
+            }
+          else
+            {
+              i++;
+            }
+        }
+
+      FishSpectrumChannelActiveSignal signal;
+      signal.m_params = txParams;
+      signal.m_end = now + txParams->duration;
+      m_activeSignals.push_back (signal);
+    }
+
+  if (!m_cullReceivers)
+    {
+      if (m_partitionByBand)
+        {
+          StartTxPartitioned (txParams);
+        }
+      else
+        {
+          SingleModelSpectrumChannel::StartTx (txParams);
+        }
+      return;
+    }
+
+  Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility ();
+  const std::vector<FishSpectrumChannelNeighbor> &neighbors = GetNeighbors (txParams->txPhy);
+
+  // The total power over all bands is never less than the in-band power a receiver compares
+  // against its noise floor, so no receiver that could hear the signal is skipped.
+  double txPower = Integral (*txParams->psd);
+
+  uint32_t numDelivered = 0;
+  for (uint32_t i = 0; i < neighbors.size (); i++)
+    {
+      const FishSpectrumChannelNeighbor &neighbor = neighbors[i];
+
+      // Receivers are sorted by threshold so none of the remaining receivers can hear the signal.
+      if (txPower < neighbor.m_minTxPower)
+        {
+          break;
+        }
+
+      // Skip receivers that have hopped to a band the signal does not occupy.
+      if (!IsTunedToSignal (*txParams->psd, neighbor.m_rxIndex))
+        {
+          continue;
+        }
+
+      ScheduleRx (txParams, txMobility, neighbor.m_phy, neighbor.m_gain);
+      numDelivered++;
+    }
+
+  NS_LOG_LOGIC (" Signal delivered to " << numDelivered << " of " << neighbors.size () << " receivers.");
+}
+
+void
+FishSpectrumChannel::StartTxPartitioned (Ptr<SpectrumSignalParameters> txParams)
+{
+  NS_LOG_FUNCTION (this << txParams);
+
+  Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility ();
+  const SpectrumValue &psd = *txParams->psd;
+
+  // Group 0 holds the receivers listening to all bands, group b + 1 the receivers tuned to band b.
+  for (uint32_t group = 0; group < m_bandMembers.size (); group++)
+    {
+      if (group > 0 && (group - 1 >= psd.GetSpectrumModel ()->GetNumBands ()
+                        || *(psd.ConstValuesBegin () + (group - 1)) == 0.0))
+        {
+          continue;
+        }
+
+      const std::vector<uint32_t> &members = m_bandMembers[group];
+      for (uint32_t i = 0; i < members.size (); i++)
+        {
+          Ptr<SpectrumPhy> rxPhy = m_rxPhys[members[i]];
+          if (rxPhy == txParams->txPhy)
+            {
+              continue;
+            }
+
+          Ptr<MobilityModel> rxMobility = rxPhy->GetMobility ();
+          double gainDb = CalculateGainDb (txParams->txPhy, txMobility, rxPhy, rxMobility);
+          ScheduleRx (txParams, txMobility, rxPhy, std::pow (10.0, gainDb / 10.0));
+        }
+    }
+}
+
+void
+FishSpectrumChannel::DeliverRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
+{
+  NS_LOG_FUNCTION (this << params);
+  receiver->StartRx (params);
+}
+
+} // namespace ns3
@@ -0,0 +1,211 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 The University Of Calgary- FISHLAB
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FISH_SPECTRUM_CHANNEL_H
+#define FISH_SPECTRUM_CHANNEL_H
+
+#include "ns3/single-model-spectrum-channel.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/spectrum-propagation-loss-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/spectrum-signal-parameters.h"
+#include "ns3/nstime.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace ns3 {
+
+/** Receiver that can hear a given transmitter.
+ */
+typedef struct
+{
+  Ptr<SpectrumPhy> m_phy;  ///< Receiving PHY.
+  uint32_t m_rxIndex;      ///< Index of the receiver in the channel.
+  double m_gain;           ///< Linear gain of the link (propagation loss and antenna gains).
+  double m_minTxPower;     ///< Smallest tx power (W) that arrives above the receiver culling threshold.
+} FishSpectrumChannelNeighbor;
+
+/** Signal on the medium, kept so receivers that hop into its band can be handed the rest of it.
+ */
+typedef struct
+{
+  Ptr<SpectrumSignalParameters> m_params;  ///< Transmitted signal.
+  Time m_end;                              ///< Time the signal leaves the medium.
+} FishSpectrumChannelActiveSignal;
+
+/**
+ * \ingroup spectrum
+ *
+ * \brief Spectrum channel that only delivers signals to receivers that can hear them.
+ *
+ * The SingleModelSpectrumChannel delivers every transmission to every PHY, even though
+ * most receivers of a large network immediately discard the signal since it is below
+ * their noise floor.  For stationary networks this channel calculates the link gain from
+ * each transmitter to every receiver once and keeps the receivers sorted by the tx power
+ * needed to reach their noise floor.  A transmission then only visits the receivers it
+ * can actually reach, so the fan-out of each frame is the node degree rather than the
+ * network size.
+ *
+ * - Tx power changes need no invalidation since the tx power of each signal is compared
+ *   against the sorted thresholds.
+ * - The cached gains are discarded whenever a receiver is added, a loss model is changed
+ *   or a mobility model reports a course change.
+ * - The scalar PropagationLossModel must be deterministic for a given pair of positions
+ *   (eg. FishLogDistanceLossModel with IsStationaryNetwork set).  Any
+ *   SpectrumPropagationLossModel is still applied to delivered signals but is not used
+ *   for culling.
+ * - Signals are culled CullingMarginDb below the receiver noise floor.  Every culled signal
+ *   is missing from the receiver's interference sum, so with many weak transmitters the
+ *   SINR is higher than without culling.  Increase the margin to keep more of that
+ *   aggregate interference.
+ * - Culling can be switched off with the ReceiverCulling attribute, in which case the
+ *   channel behaves exactly like SingleModelSpectrumChannel.
+ *
+ * Receivers are also partitioned by the band (channel) they are tuned to.  PHYs report
+ * band changes with SetRxBand() and a signal is only delivered to receivers tuned to a
+ * band in which the signal has energy.  Receivers that have never reported a band receive
+ * every signal.  Since node clocks are not aligned, a receiver can hop into a band while a
+ * signal is already on it.  SetRxBand() returns the remainder of those signals so the PHY
+ * can count them as interference.  Partitioning can be switched off with the
+ * ChannelPartitioning attribute.
+ */
+class FishSpectrumChannel : public SingleModelSpectrumChannel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  FishSpectrumChannel ();
+  virtual ~FishSpectrumChannel ();
+
+  // inherited from SpectrumChannel
+  virtual void AddPropagationLossModel (Ptr<PropagationLossModel> loss);
+  virtual void AddSpectrumPropagationLossModel (Ptr<SpectrumPropagationLossModel> loss);
+  virtual void SetPropagationDelayModel (Ptr<PropagationDelayModel> delay);
+  virtual void AddRx (Ptr<SpectrumPhy> phy);
+  virtual void StartTx (Ptr<SpectrumSignalParameters> params);
+
+  /** Discard the neighbor lists of all transmitters.
+   * - The lists are rebuilt the next time each node transmits.
+   */
+  void InvalidateNeighbors (void);
+
+  /** Set the band a receiver is tuned to.
+   * - The PHY must already have been added with AddRx().
+   * - Signals that are still on the medium in the new band, and were not delivered to the
+   *   receiver in its old band, are returned with the receiver's link gain applied and their
+   *   remaining duration.  They started before the receiver arrived, so they can only be
+   *   interference.  Propagation delay is ignored for them.
+   *
+   * @param phy The receiving PHY.
+   * @param band Index of the band in the spectrum model, or -1 to receive all bands.
+   * @return Signals the receiver missed while it was tuned to another band.
+   */
+  std::vector<Ptr<SpectrumSignalParameters> > SetRxBand (Ptr<const SpectrumPhy> phy, int32_t band);
+
+private:
+  virtual void DoDispose ();
+
+  /** Get the receivers that can hear a transmitter, building the list if required.
+   *
+   * @param txPhy The transmitting PHY.
+   * @return Receivers sorted by increasing tx power required to reach them.
+   */
+  const std::vector<FishSpectrumChannelNeighbor>& GetNeighbors (Ptr<SpectrumPhy> txPhy);
+
+  /** Track course changes of a mobility model so the neighbor lists can be invalidated.
+   *
+   * @param mobility The mobility model.
+   */
+  void TrackMobility (Ptr<MobilityModel> mobility);
+
+  /** Called when a tracked mobility model changes position.
+   *
+   * @param mobility The mobility model that moved.
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+
+  /** Deliver a signal to a receiver once the propagation delay has elapsed.
+   *
+   * @param params The received signal.
+   * @param receiver The receiving PHY.
+   */
+  void DeliverRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
+
+  /** Calculate the gain of a link, including the antenna gains.
+   *
+   * @return Link gain (dB).
+   */
+  double CalculateGainDb (Ptr<SpectrumPhy> txPhy, Ptr<MobilityModel> txMobility,
+                          Ptr<SpectrumPhy> rxPhy, Ptr<MobilityModel> rxMobility) const;
+
+  /** Apply the link gain and schedule the arrival of a signal at a receiver.
+   *
+   * @param txParams The transmitted signal.
+   * @param txMobility Mobility model of the transmitter.
+   * @param rxPhy The receiving PHY.
+   * @param gain Linear gain of the link.
+   */
+  void ScheduleRx (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                   Ptr<SpectrumPhy> rxPhy, double gain);
+
+  /** Check whether a receiver is tuned to a band the signal occupies.
+   *
+   * @param psd The transmitted PSD.
+   * @param rxIndex Index of the receiver.
+   * @return True if the signal should be delivered.
+   */
+  bool IsTunedToSignal (const SpectrumValue &psd, uint32_t rxIndex) const;
+
+  /** Check whether a signal has energy in a band.
+   *
+   * @param psd The transmitted PSD.
+   * @param band Index of the band, -1 for all bands.
+   */
+  static bool OccupiesBand (const SpectrumValue &psd, int32_t band);
+
+  /** Deliver a signal to all receivers tuned to its bands without culling.
+   *
+   * @param txParams The transmitted signal.
+   */
+  void StartTxPartitioned (Ptr<SpectrumSignalParameters> txParams);
+
+  bool m_cullReceivers;               ///< Only deliver signals to receivers that can hear them.
+  bool m_partitionByBand;             ///< Only deliver signals to receivers tuned to an occupied band.
+  double m_defaultNoiseFloorDbm;      ///< Noise floor (dBm) used for PHYs without a NoiseFloorDbm attribute.
+  double m_cullingMarginDb;           ///< Signals are culled this far below the receiver noise floor (dB).
+
+  std::vector<Ptr<SpectrumPhy> > m_rxPhys;  ///< All receivers attached to the channel.
+  std::map<const SpectrumPhy*, uint32_t> m_rxIndex;  ///< Index of each receiver in m_rxPhys.
+  std::vector<int32_t> m_rxBand;      ///< Band each receiver is tuned to (-1 for all bands).
+  std::vector<std::vector<uint32_t> > m_bandMembers;  ///< Receivers tuned to each band, offset by one (0 holds receivers of all bands).
+  std::vector<uint32_t> m_rxPosInBand;  ///< Position of each receiver in its m_bandMembers list.
+  std::map<const SpectrumPhy*, std::vector<FishSpectrumChannelNeighbor> > m_neighbors;  ///< Neighbor list of each transmitter.
+  std::set<const MobilityModel*> m_trackedMobility;  ///< Mobility models with a connected course change trace.
+  std::vector<FishSpectrumChannelActiveSignal> m_activeSignals;  ///< Signals on the medium (only kept when partitioning).
+
+  Ptr<PropagationLossModel> m_propagationLoss;
+  Ptr<SpectrumPropagationLossModel> m_spectrumPropagationLoss;
+  Ptr<PropagationDelayModel> m_propagationDelay;
+};
+
+} // namespace ns3
+
+#endif /* FISH_SPECTRUM_CHANNEL_H */
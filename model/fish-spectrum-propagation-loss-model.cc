@@ -20,6 +20,8 @@
  */
 
 #include <ns3/mobility-model.h>
+#include <ns3/pointer.h>
+#include <ns3/boolean.h>
 #include <ns3/fish-spectrum-propagation-loss-model.h>
 #include <math.h>
 
@@ -30,11 +32,13 @@ NS_OBJECT_ENSURE_REGISTERED (FishSpectrumPropagationLossModel);
 FishSpectrumPropagationLossModel::FishSpectrumPropagationLossModel ()
 {
   m_simpleLossModel = 0;
+  m_cacheGains = false;
 }
 
 FishSpectrumPropagationLossModel::~FishSpectrumPropagationLossModel ()
 {
   m_simpleLossModel = 0;
+  m_gainCache.clear ();
 }
 
 TypeId
@@ -43,6 +47,17 @@ FishSpectrumPropagationLossModel::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::FishSpectrumPropagationLossModel")
     .SetParent<SpectrumPropagationLossModel> ()
     .AddConstructor<FishSpectrumPropagationLossModel> ()
+    .AddAttribute ("PropagationLossModel",
+                   "The frequency flat loss model used to calculate the loss between two nodes.",
+                   PointerValue (),
+                   MakePointerAccessor (&FishSpectrumPropagationLossModel::SetPropagationLossModel,
+                                        &FishSpectrumPropagationLossModel::GetPropagationLossModel),
+                   MakePointerChecker<PropagationLossModel> ())
+    .AddAttribute ("CacheGains",
+                   "Cache the gain of each transmitter/receiver pair.  Only valid for stationary networks.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&FishSpectrumPropagationLossModel::m_cacheGains),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -52,25 +67,67 @@ FishSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensity (Ptr<const Spectr
                                                                 Ptr<const MobilityModel> a,
                                                                 Ptr<const MobilityModel> b) const
 {
-  Ptr<SpectrumValue> rxPsd = Copy<SpectrumValue> (txPsd);
-  Values::iterator vit = rxPsd->ValuesBegin ();
-  Bands::const_iterator fit = rxPsd->ConstBandsBegin ();
-
   NS_ASSERT (a);
   NS_ASSERT (b);
 
-  //double d = a->GetDistanceFrom (b);
+  // The loss is the same in every band so only calculate it once.
+  double gain = GetPairGain (a, b);
+
+  Ptr<SpectrumValue> rxPsd = Copy<SpectrumValue> (txPsd);
+  Values::iterator vit = rxPsd->ValuesBegin ();
 
   while (vit != rxPsd->ValuesEnd ())
     {
-      NS_ASSERT (fit != rxPsd->ConstBandsEnd ());
-      *vit /= CalculateLossFromSimpleLossModel (a, b); // Prx = Ptx / loss
+      // Only the occupied channel of the PSD is non-zero.
+      if (*vit != 0.0)
+        {
+          *vit *= gain; // Prx = Ptx / loss
+        }
       ++vit;
-      ++fit;
     }
   return rxPsd;
 }
 
+void
+FishSpectrumPropagationLossModel::SetPropagationLossModel (Ptr<PropagationLossModel> model)
+{
+  m_simpleLossModel = model;
+  m_gainCache.clear ();
+}
+
+Ptr<PropagationLossModel>
+FishSpectrumPropagationLossModel::GetPropagationLossModel (void) const
+{
+  return m_simpleLossModel;
+}
+
+void
+FishSpectrumPropagationLossModel::ClearGainCache (void)
+{
+  m_gainCache.clear ();
+}
+
+double
+FishSpectrumPropagationLossModel::GetPairGain (Ptr<const MobilityModel> a,
+                                               Ptr<const MobilityModel> b) const
+{
+  if (!m_cacheGains)
+    {
+      return 1.0 / CalculateLossFromSimpleLossModel (a, b);
+    }
+
+  MobilityPair key (PeekPointer (a), PeekPointer (b));
+  std::map<MobilityPair, double>::iterator it = m_gainCache.find (key);
+  if (it != m_gainCache.end ())
+    {
+      return it->second;
+    }
+
+  double gain = 1.0 / CalculateLossFromSimpleLossModel (a, b);
+  m_gainCache.insert (std::make_pair (key, gain));
+  return gain;
+}
+
 double
 FishSpectrumPropagationLossModel::CalculateLossFromSimpleLossModel (Ptr<const MobilityModel> a,
                                                                     Ptr<const MobilityModel> b) const
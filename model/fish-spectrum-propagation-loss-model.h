@@ -24,12 +24,18 @@
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-loss-model.h>
 
+#include <map>
+
 namespace ns3 {
 
 class MobilityModel;
 
 /**
  * \brief propagation loss model for WPAN that uses simple PropagationLossModel
+ *
+ * The loss is frequency flat, so the simple loss model is evaluated once per
+ * transmitter/receiver pair and applied only to the occupied bands of the PSD.
+ * For stationary networks the linear gain of each pair can also be cached.
  */
 class FishSpectrumPropagationLossModel : public SpectrumPropagationLossModel
 {
@@ -45,11 +51,38 @@ public:
                                                            Ptr<const MobilityModel> a,
                                                            Ptr<const MobilityModel> b) const;
 
+  /** Set the simple (frequency flat) loss model used to calculate the loss.
+   *
+   * @param model Pointer to the propagation loss model.
+   */
+  void SetPropagationLossModel (Ptr<PropagationLossModel> model);
+
+  /** Get the simple loss model used to calculate the loss.
+   *
+   * @return Pointer to the propagation loss model.
+   */
+  Ptr<PropagationLossModel> GetPropagationLossModel (void) const;
+
+  /** Discard all cached pair gains.
+   * - Must be called if nodes move or the simple loss model changes while gain caching is enabled.
+   */
+  void ClearGainCache (void);
+
 
 private:
   double CalculateLossFromSimpleLossModel (Ptr<const MobilityModel> a,
                                            Ptr<const MobilityModel> b) const;
+
+  /** Get the linear gain (1/loss) between two nodes.
+   * - Uses the cached value if gain caching is enabled and the pair has been seen before.
+   */
+  double GetPairGain (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b) const;
+
+  typedef std::pair<const MobilityModel*, const MobilityModel*> MobilityPair;
+
   Ptr<PropagationLossModel> m_simpleLossModel;
+  bool m_cacheGains;  ///< Cache the gain of each transmitter/receiver pair (stationary networks only).
+  mutable std::map<MobilityPair, double> m_gainCache;  ///< Linear gain of each transmitter/receiver pair.
 
 };
 
@@ -80,6 +80,25 @@ FishWpanSpectrumValueHelper::CreateTxPowerSpectralDensity (double txPower, uint3
   return txPsd;
 }
 
+Ptr<const SpectrumValue>
+FishWpanSpectrumValueHelper::GetTxPowerSpectralDensity (double txPower, uint32_t channel)
+{
+  // Tx powers are whole dBm and there are only 16 channels so the cache stays small.
+  static std::map<std::pair<double, uint32_t>, Ptr<const SpectrumValue> > txPsdCache;
+
+  std::pair<double, uint32_t> key (txPower, channel);
+  std::map<std::pair<double, uint32_t>, Ptr<const SpectrumValue> >::iterator it = txPsdCache.find (key);
+  if (it != txPsdCache.end ())
+    {
+      return it->second;
+    }
+
+  FishWpanSpectrumValueHelper psdHelper;
+  Ptr<SpectrumValue> txPsd = psdHelper.CreateTxPowerSpectralDensity (txPower, channel);
+  txPsdCache[key] = txPsd;
+  return txPsd;
+}
+
 Ptr<SpectrumValue>
 FishWpanSpectrumValueHelper::CreateNoisePowerSpectralDensity (uint32_t channel)
 {
@@ -108,10 +127,21 @@ FishWpanSpectrumValueHelper::TotalAvgPower (const SpectrumValue &psd)
   double totalAvgPower = 0.0;
 
   // numerically integrate to get area under psd using the 2MHz band resolution.
+  // - Summed in place rather than with Sum(psd * 2.0e6) which creates a temporary SpectrumValue.
+  for (Values::const_iterator it = psd.ConstValuesBegin (); it != psd.ConstValuesEnd (); ++it)
+    {
+      totalAvgPower += *it;
+    }
+
+  return totalAvgPower * 2.0e6;
+}
 
-  totalAvgPower = Sum (psd * 2.0e6);
+double
+FishWpanSpectrumValueHelper::InBandPower (const SpectrumValue &psd, uint32_t channel)
+{
+  NS_ASSERT_MSG ((channel >= 11 && channel <= 26), "Invalid channel numbers");
 
-  return totalAvgPower;
+  return *(psd.ConstValuesBegin () + (channel - 11)) * 2.0e6;
 }
 
 } // namespace ns3
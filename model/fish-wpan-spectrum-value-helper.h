@@ -22,6 +22,7 @@
 
 #include <ns3/spectrum-value.h>
 #include <cmath>
+#include <map>
 
 namespace ns3 {
 
@@ -44,6 +45,16 @@ public:
    */
   Ptr<SpectrumValue> CreateTxPowerSpectralDensity (double txPower, uint32_t channel);
 
+  /**
+   * \brief get a shared tx spectrum value
+   * - PSDs are created once for each (power, channel) pair and shared by all callers,
+   *   so the value is const.  Copy it where a mutable PSD is needed.
+   * \param txPower the power transmission in dBm
+   * \param channel the channel number per IEEE802.15.4
+   * \return a Ptr to the shared SpectrumValue instance
+   */
+  static Ptr<const SpectrumValue> GetTxPowerSpectralDensity (double txPower, uint32_t channel);
+
   /**
    * \brief create spectrum value for noise
    * \param channel the channel number per IEEE802.15.4
@@ -58,6 +69,15 @@ public:
    */
   double TotalAvgPower (const SpectrumValue &psd);
 
+  /**
+   * \brief power of the signal within a single channel
+   * - Reads the PSD in place so no temporary SpectrumValue is created.
+   * \param psd power spectral density
+   * \param channel the channel number per IEEE802.15.4
+   * \return power (W) in the channel
+   */
+  static double InBandPower (const SpectrumValue &psd, uint32_t channel);
+
 private:
   double m_noiseFactor;
 
@@ -31,6 +31,7 @@
 #include "ns3/log.h"
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
+#include "ns3/enum.h"
 #include "ns3/packet.h"
 
 // Broadcast packet information
@@ -92,6 +93,13 @@ TypeId Isa100Application::GetTypeId (void)
 				MakeMac16AddressAccessor (&Isa100Application::m_srcAddress),
 				MakeMac16AddressChecker ())
 
+		.AddAttribute ("Priority", "DL priority class of the packets sent by the application.",
+				EnumValue (DL_PRIORITY_PERIODIC),
+				MakeEnumAccessor (&Isa100Application::m_priority),
+				MakeEnumChecker (DL_PRIORITY_PERIODIC, "Periodic",
+				                 DL_PRIORITY_CONTROL, "Control",
+				                 DL_PRIORITY_ALARM, "Alarm"))
+
 				;
   return tid;
 }
@@ -205,6 +213,7 @@ void Isa100PacketGeneratorApplication::SendPacket()
 	params.m_destAddr = m_dstAddress;
 	params.m_dsduLength = m_packetSize;
 	params.m_dsduHandle = 0;  // Consider getting rid of this parameter.
+	params.m_priority = m_priority;
 
 	m_dlDataRequest(params,p);
 
@@ -294,6 +303,7 @@ void Isa100FieldNodeApplication::SensorSampleCallback(double data)
   params.m_srcAddr = m_srcAddress;
   params.m_destAddr = m_dstAddress;
   params.m_dsduLength = m_packetSize;
+  params.m_priority = m_priority;
 
   // Send the packet to the sink and put the processor to sleep.
   m_dlDataRequest(params,measurementPacket);
@@ -160,6 +160,7 @@ protected:
   Mac16Address m_dstAddress;  ///< Address of the packet destination.
   Mac16Address m_srcAddress;  ///< Address of the node hosting the application object.
   Time m_startTime; ///< Start time for the application.
+  Isa100DlPriority m_priority; ///< DL priority class of the packets sent.
 
   DlDataRequestCallback m_dlDataRequest;  ///< Pointer to the ISA100 DL data request routine.
 };
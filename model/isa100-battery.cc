@@ -24,7 +24,10 @@
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/nstime.h"
 #include <map>
+#include <algorithm>
 
 #include "ns3/mac16-address.h"
 #include "ns3/simulator.h"
@@ -48,11 +51,31 @@ Isa100Battery::GetTypeId (void)
             MakeDoubleAccessor(&Isa100Battery::m_energy),
             MakeDoubleChecker<double>())
 
+    .AddAttribute ("PredictDepletion","Schedule an event at the predicted time of depletion rather than waiting for the next state change of a consumer.",
+            BooleanValue(false),
+            MakeBooleanAccessor(&Isa100Battery::m_predictDepletion),
+            MakeBooleanChecker())
+
+    .AddAttribute ("AggregateEnergyTrace","Replace the EnergyConsumption trace of every decrement with one AggregatedEnergyConsumption record per interval.",
+            BooleanValue(false),
+            MakeBooleanAccessor(&Isa100Battery::SetAggregateEnergyTrace, &Isa100Battery::GetAggregateEnergyTrace),
+            MakeBooleanChecker())
+
+    .AddAttribute ("EnergyTraceInterval","Interval between aggregated energy records.  Zero emits one record per DL superframe.",
+            TimeValue(Seconds(0.0)),
+            MakeTimeAccessor(&Isa100Battery::SetEnergyTraceInterval, &Isa100Battery::GetEnergyTraceInterval),
+            MakeTimeChecker())
+
 		.AddTraceSource("EnergyConsumption",
 				" Trace tracking energy consumed by category.",
 				MakeTraceSourceAccessor (&Isa100Battery::m_energyConsumptionTrace),
 				"ns3::TracedCallback::Energy")
 
+		.AddTraceSource("AggregatedEnergyConsumption",
+				" Energy consumed by each category over an interval.",
+				MakeTraceSourceAccessor (&Isa100Battery::m_aggregatedEnergyTrace),
+				"ns3::TracedCallback::AggregatedEnergy")
+
   ;
   return tid;
 }
@@ -63,7 +86,16 @@ Isa100Battery::Isa100Battery ()
   NS_LOG_FUNCTION (this);
 
   m_energy = 0;
+  m_initEnergy = 0;
   m_device = 0;
+
+  m_predictDepletion = false;
+  m_totalPower = 0;
+  m_depleted = false;
+  m_drainedEnergy = 0;
+
+  m_aggregateTrace = false;
+  m_intervalStart = Seconds(0.0);
 }
 
 Isa100Battery::~Isa100Battery ()
@@ -71,30 +103,82 @@ Isa100Battery::~Isa100Battery ()
   NS_LOG_FUNCTION (this);
 }
 
+void Isa100Battery::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+
+  m_depletionEvent.Cancel();
+  m_traceEvent.Cancel();
+  m_device = 0;
+  m_energyModel = 0;
+  Object::DoDispose();
+}
+
 
 void Isa100Battery::SetInitEnergy(double initEnergy)
 {
 	m_initEnergy = initEnergy;
 	m_energy = m_initEnergy;
+
+	// Consumption before the battery was charged isn't counted.
+	m_consumerUpdateTime.assign(m_consumerUpdateTime.size(), Simulator::Now());
+	m_depleted = false;
+	UpdateDepletionPrediction();
+
+	// A recharged battery resumes the aggregated records.
+	if(!m_traceEvent.IsRunning())
+		RestartEnergyTraceTimer();
 }
 
 void Isa100Battery::ZeroConsumptionCategories()
 {
-  map<string,double>::iterator categoryIter;
-  for(categoryIter = m_energyBreakdown.begin(); categoryIter != m_energyBreakdown.end(); categoryIter++)
-  	categoryIter->second = 0;
+  Flush();
+  m_energyBreakdown.assign(m_energyBreakdown.size(), 0.0);
+  m_intervalBreakdown.assign(m_intervalBreakdown.size(), 0.0);
+  m_intervalStart = Simulator::Now();
 }
 
-void Isa100Battery::SetConsumptionCategories(vector<string> &categories)
+vector<uint32_t> Isa100Battery::SetConsumptionCategories(vector<string> &categories)
 {
-	for(int n=0; n < categories.size(); n++){
-		m_energyBreakdown[categories[n]] = 0;
+	vector<uint32_t> ids(categories.size());
+	uint32_t consumer = m_consumerPower.size();
+	m_consumerPower.push_back(0);
+	m_consumerUpdateTime.push_back(Simulator::Now());
+
+	for(uint32_t n=0; n < categories.size(); n++){
+		map<string,uint32_t>::iterator it = m_categoryIds.find(categories[n]);
+		if(it == m_categoryIds.end()){
+			it = m_categoryIds.insert(std::make_pair(categories[n], (uint32_t)m_categoryNames.size())).first;
+			m_categoryNames.push_back(categories[n]);
+			m_energyBreakdown.push_back(0);
+			m_intervalBreakdown.push_back(0);
+			m_categoryConsumer.push_back(consumer);
+		}
+		else
+		{
+			// The consumer that previously owned the category is replaced.
+			uint32_t oldConsumer = m_categoryConsumer[it->second];
+			IntegrateConsumer(oldConsumer);
+			m_totalPower -= m_consumerPower[oldConsumer];
+			m_consumerPower[oldConsumer] = 0;
+
+			m_energyBreakdown[it->second] = 0;
+			m_categoryConsumer[it->second] = consumer;
+		}
+
+		ids[n] = it->second;
 	}
+
+	m_consumerCategory.push_back(categories.empty() ? 0 : ids[0]);
+
+	return ids;
 }
 
 void Isa100Battery::SetDevicePointer(Ptr<NetDevice> device)
 {
 	m_device = device;
+	if(m_device)
+		m_address = Mac16Address::ConvertFrom(m_device->GetAddress());
 }
 
 void Isa100Battery::SetBatteryDepletionCallback(BatteryDepletionCallback c)
@@ -107,12 +191,72 @@ double Isa100Battery::GetEnergy() const
 	return m_energy;
 }
 
+double Isa100Battery::GetRemainingEnergy() const
+{
+	Time now = Simulator::Now();
+	double pending = 0;
+	for(uint32_t n=0; n < m_consumerPower.size(); n++)
+		pending += m_consumerPower[n] * (now - m_consumerUpdateTime[n]).GetSeconds();
+
+	return m_energy - pending;
+}
+
+void Isa100Battery::IntegrateConsumer(uint32_t consumer)
+{
+	Time now = Simulator::Now();
+	double amount = m_consumerPower[consumer] * (now - m_consumerUpdateTime[consumer]).GetSeconds();
+
+	// Updated first since a depletion triggered by the decrement flushes all consumers.
+	m_consumerUpdateTime[consumer] = now;
+
+	if(amount > 0)
+		DecrementEnergy(m_consumerCategory[consumer], amount);
+}
+
+void Isa100Battery::Flush()
+{
+	for(uint32_t n=0; n < m_consumerPower.size(); n++)
+		IntegrateConsumer(n);
+}
+
+void Isa100Battery::SetEnergySource(Ptr<EnergySource> source)
+{
+	NS_LOG_FUNCTION(this << source);
+
+	m_energyModel = CreateObject<Isa100DeviceEnergyModel> ();
+	m_energyModel->SetEnergySource(source);
+	m_energyModel->SetDepletionCallback(MakeCallback(&Isa100Battery::SourceDepleted, this));
+	source->AppendDeviceEnergyModel(m_energyModel);
+
+	m_energyModel->SetPowerDraw(m_totalPower);
+}
+
+void Isa100Battery::SourceDepleted()
+{
+	Deplete(0.0);
+}
+
+void Isa100Battery::DrainEnergy(double amount)
+{
+	NS_LOG_FUNCTION(this << amount);
+
+	m_drainedEnergy += amount;
+	m_energy -= amount;
+
+	m_energyConsumptionTrace(m_address, "FastForward", amount, m_energy, m_initEnergy);
+
+	if(m_energy <= 0)
+		Deplete(amount);
+	else
+		UpdateDepletionPrediction();
+}
+
 double Isa100Battery::GetInitialEnergy() const
 {
 	return m_initEnergy;
 }
 
-void Isa100Battery::DecrementEnergy(string category, double amount)
+void Isa100Battery::DecrementEnergy(uint32_t category, double amount)
 {
   // Do not update if simulation has finished
   if (Simulator::IsFinished ())
@@ -120,42 +264,193 @@ void Isa100Battery::DecrementEnergy(string category, double amount)
     return;
   }
 
+	NS_ASSERT_MSG(category < m_energyBreakdown.size(), "Energy category " << category << " has not been defined.");
+
 	m_energyBreakdown[category] += amount;
 	m_energy -= amount;
 
 	NS_ASSERT(m_device != 0);
-  Mac16Address addr = Mac16Address::ConvertFrom(m_device->GetAddress());
+  Mac16Address addr = m_address;
 
-  m_energyConsumptionTrace(addr, category, amount, m_energy, m_initEnergy);
+  if(m_aggregateTrace)
+  	m_intervalBreakdown[category] += amount;
+  else
+  	m_energyConsumptionTrace(addr, m_categoryNames[category], amount, m_energy, m_initEnergy);
 
-  NS_LOG_LOGIC(Simulator::Now().GetSeconds() << "s: Node " << addr << " has consumed " << amount << "uJ in category " << category << " (Total Battery: " << m_energy << ")");
+  NS_LOG_LOGIC(Simulator::Now().GetSeconds() << "s: Node " << addr << " has consumed " << amount << "uJ in category " << m_categoryNames[category] << " (Total Battery: " << m_energy << ")");
+
+	if(m_energy <= 0)
+		Deplete(amount);
+}
 
-	if(m_energy <= 0){
+void Isa100Battery::Deplete(double amount)
+{
+	if(m_depleted){
 		m_energy = 0;
-	  m_energyConsumptionTrace(addr, "DEPLETION", amount, m_energy, m_initEnergy);
+		return;
+	}
 
-		if(!m_depletionCallback.IsNull()){
-			m_depletionCallback(addr);
-		}
+	m_depleted = true;
+	m_depletionEvent.Cancel();
+
+	// Charge the consumption up to now to the categories before the battery is emptied.
+	Flush();
+	m_energy = 0;
+
+	NS_LOG_LOGIC(Simulator::Now().GetSeconds() << "s: Node " << m_address << " battery depleted");
+
+	m_energyConsumptionTrace(m_address, "DEPLETION", amount, m_energy, m_initEnergy);
+
+	// Report the partial interval up to depletion, nothing is consumed after it.
+	EndEnergyInterval();
+	m_traceEvent.Cancel();
+
+	if(!m_depletionCallback.IsNull()){
+		m_depletionCallback(m_address);
 	}
 }
 
+void Isa100Battery::SetPowerDraw(uint32_t category, double power)
+{
+	NS_ASSERT_MSG(category < m_categoryConsumer.size(), "Energy category " << category << " has not been defined.");
+
+  // Do not update if simulation has finished
+  if (Simulator::IsFinished ())
+  {
+    return;
+  }
+
+	// Decrement the old draw up to now before switching to the new one.
+	uint32_t consumer = m_categoryConsumer[category];
+	IntegrateConsumer(consumer);
+	m_consumerCategory[consumer] = category;
+
+	if(m_consumerPower[consumer] == power)
+		return;
+
+	m_consumerPower[consumer] = power;
+
+	// Only a handful of consumers so re-summing avoids accumulating rounding errors.
+	m_totalPower = 0;
+	for(uint32_t n=0; n < m_consumerPower.size(); n++)
+		m_totalPower += m_consumerPower[n];
+
+	if(m_energyModel)
+		m_energyModel->SetPowerDraw(m_totalPower);
+
+	UpdateDepletionPrediction();
+}
+
+Time Isa100Battery::GetPredictedDepletionTime() const
+{
+	if(m_depleted)
+		return Simulator::Now();
+
+	if(m_totalPower <= 0)
+		return Time::Max();
+
+	double remaining = GetRemainingEnergy();
+	return Simulator::Now() + Seconds(std::max(remaining, 0.0) / m_totalPower);
+}
+
+void Isa100Battery::UpdateDepletionPrediction()
+{
+	if(!m_predictDepletion || m_depleted)
+		return;
+
+	m_depletionEvent.Cancel();
+
+	Time depletionTime = GetPredictedDepletionTime();
+	if(depletionTime == Time::Max())
+		return;
+
+	NS_LOG_LOGIC(Simulator::Now().GetSeconds() << "s: Node " << m_address << " draws " << m_totalPower << " uJ/s, depletion predicted at " << depletionTime.GetSeconds() << "s");
+
+	m_depletionEvent = Simulator::Schedule(depletionTime - Simulator::Now(), &Isa100Battery::Deplete, this, 0.0);
+}
+
+const vector<string>& Isa100Battery::GetCategoryNames() const
+{
+	return m_categoryNames;
+}
+
+void Isa100Battery::EndEnergyInterval()
+{
+	if(!m_aggregateTrace)
+		return;
+
+	Flush();
+
+	m_aggregatedEnergyTrace(m_address, m_intervalStart, m_intervalBreakdown, m_energy);
+
+	m_intervalBreakdown.assign(m_intervalBreakdown.size(), 0.0);
+	m_intervalStart = Simulator::Now();
+}
+
+void Isa100Battery::FrameComplete(uint16_t remainingSlots)
+{
+	if(m_traceInterval.IsZero() && !m_depleted)
+		EndEnergyInterval();
+}
+
+void Isa100Battery::SetAggregateEnergyTrace(bool aggregate)
+{
+	m_aggregateTrace = aggregate;
+	RestartEnergyTraceTimer();
+}
+
+bool Isa100Battery::GetAggregateEnergyTrace() const
+{
+	return m_aggregateTrace;
+}
+
+void Isa100Battery::SetEnergyTraceInterval(Time interval)
+{
+	m_traceInterval = interval;
+	RestartEnergyTraceTimer();
+}
+
+Time Isa100Battery::GetEnergyTraceInterval() const
+{
+	return m_traceInterval;
+}
+
+void Isa100Battery::RestartEnergyTraceTimer()
+{
+	m_traceEvent.Cancel();
+	if(m_aggregateTrace && m_traceInterval.IsStrictlyPositive() && !m_depleted)
+		m_traceEvent = Simulator::Schedule(m_traceInterval, &Isa100Battery::EnergyTraceTimeout, this);
+}
+
+void Isa100Battery::EnergyTraceTimeout()
+{
+	EndEnergyInterval();
+	m_traceEvent = Simulator::Schedule(m_traceInterval, &Isa100Battery::EnergyTraceTimeout, this);
+}
+
 void Isa100Battery::PrintEnergySummary (Ptr<OutputStreamWrapper> stream)
 {
   int64_t timenow = Simulator::Now().GetNanoSeconds();
 
+  Flush();
+
 	NS_ASSERT(m_device != 0);
-  Mac16Address addr = Mac16Address::ConvertFrom(m_device->GetAddress());
+  Mac16Address addr = m_address;
 
   *stream->GetStream()
 	        << timenow << "," << addr << ",Total," << m_energy << std::endl;
 
-  map<string,double>::iterator categoryIter;
-  for(categoryIter = m_energyBreakdown.begin(); categoryIter != m_energyBreakdown.end(); categoryIter++){
+  // Categories are printed in alphabetical order.
+  map<string,uint32_t>::iterator categoryIter;
+  for(categoryIter = m_categoryIds.begin(); categoryIter != m_categoryIds.end(); categoryIter++){
   	*stream->GetStream()
-  	        << timenow << "," << addr << "," << categoryIter->first << "," << categoryIter->second << std::endl;
+  	        << timenow << "," << addr << "," << categoryIter->first << "," << m_energyBreakdown[categoryIter->second] << std::endl;
   }
 
+  if(m_drainedEnergy > 0)
+  	*stream->GetStream()
+  	        << timenow << "," << addr << ",FastForward," << m_drainedEnergy << std::endl;
+
 }
 
 
@@ -27,9 +27,13 @@
 #include <string>
 #include <vector>
 #include "ns3/event-id.h"
+#include "ns3/nstime.h"
 #include "ns3/traced-callback.h"
 #include "ns3/net-device.h"
+#include "ns3/mac16-address.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/energy-source.h"
+#include "ns3/isa100-device-energy-model.h"
 
 
 
@@ -37,13 +41,12 @@ using namespace ns3;
 using namespace std;
 
 
-/** Callback to decrement battery energy
+/** Callback to report a change in the state of a battery consumer.
  *
- * @param category String indicating category name.
- * @param amount Amount of energy to decrement (uJ).
+ * @param category ID of the category the consumer has switched to.
+ * @param power Power now drawn by the consumer (uJ/s).
  */
-typedef Callback< void, string, double > BatteryDecrementCallback;
-
+typedef Callback< void, uint32_t, double > BatteryPowerDrawCallback;
 
 /** Callback used when battery energy is depleted.
  *
@@ -61,6 +64,15 @@ typedef Callback< void, Mac16Address > BatteryDepletionCallback;
  */
 typedef TracedCallback<Mac16Address, std::string, double, double, double> BatteryEnergyTraceCallback;
 
+/** Aggregated energy consumption trace callback.
+ *
+ * @param address Address of node.
+ * @param start Start of the interval covered by the record.
+ * @param breakdown Energy consumed by each category during the interval, indexed by category ID (uJ).
+ * @param currEnergy Current amount of energy (uJ).
+ */
+typedef TracedCallback<Mac16Address, Time, const vector<double>&, double> BatteryAggregatedEnergyTraceCallback;
+
 class Isa100Battery : public Object
 {
 public:
@@ -76,18 +88,68 @@ public:
    */
   void SetInitEnergy(double initEnergy);
 
-  /** Define a category that identifies a type of energy consumption.
+  /** Define categories that identify types of energy consumption.
+   * - Each name is assigned a small integer ID used by DecrementEnergy().
+   * - Names that are already defined keep their existing ID.
    *
-   * @param category String identifying the energy consumption category.
+   * @param categories Strings identifying the energy consumption categories.
+   * @return The ID of each category, in the same order as categories.
    */
-  void SetConsumptionCategories(vector<string> &categories);
+  vector<uint32_t> SetConsumptionCategories(vector<string> &categories);
 
   /** Decrement battery energy.
    *
-   * @param category The energy consumption category.
+   * @param category ID of the energy consumption category.
    * @param amount Amount of energy to decrement in uJ.
    */
-  void DecrementEnergy(string category, double amount);
+  void DecrementEnergy(uint32_t category, double amount);
+
+  /** Report a state change of one of the battery consumers (PHY, processor or sensor).
+   * - Each call to SetConsumptionCategories() defines one consumer, identified by its categories.
+   * - The energy drawn by the consumer since its last report is decremented from the category
+   *   of its previous state.  This is the only place consumption is integrated: the consumers
+   *   only report their new category and power.
+   * - Any energy source set by SetEnergySource() is updated with the new total draw.
+   * - When PredictDepletion is enabled, the battery keeps exactly one event scheduled at the
+   *   predicted time of depletion.  The event is only rescheduled when the draw changes.
+   *
+   * @param category ID of the category the consumer has switched to.
+   * @param power Power now drawn by the consumer (uJ/s).
+   */
+  void SetPowerDraw(uint32_t category, double power);
+
+  /** Get the predicted time of depletion.
+   *
+   * @return Absolute simulation time of depletion, or Time::Max() if it cannot be predicted.
+   */
+  Time GetPredictedDepletionTime() const;
+
+  /** Get the energy left in the battery, integrated from the reported power draw up to now.
+   * - Unlike GetEnergy(), this includes the consumption since the last state change of each consumer.
+   *
+   * @return Energy (uJ).
+   */
+  double GetRemainingEnergy() const;
+
+  /** Decrement the consumption of every consumer up to the current time.
+   *
+   */
+  void Flush();
+
+  /** Report the total power draw to an ns-3 energy source.
+   * - An Isa100DeviceEnergyModel is installed on the source and updated every time the total
+   *   draw changes.  Depletion of the source also depletes the battery.
+   *
+   * @param source Energy source.
+   */
+  void SetEnergySource(Ptr<EnergySource> source);
+
+  /** Remove energy without simulating its consumption (used to fast forward lifetime simulations).
+   * - Reported in the energy summary under the FastForward category.
+   *
+   * @param amount Amount of energy to remove (uJ).
+   */
+  void DrainEnergy(double amount);
 
   /** Get amount of energy in the battery.
    *
@@ -100,6 +162,7 @@ public:
   double GetInitialEnergy() const;
 
   /** Set the net device pointer.
+   * - The address of the device is cached for tracing.
    *
    * @param device Pointer to the net device.
    */
@@ -111,6 +174,26 @@ public:
    */
   void SetBatteryDepletionCallback(BatteryDepletionCallback c);
 
+  /** Get the category names.
+   *
+   * @return Name of each category, indexed by category ID.
+   */
+  const vector<string>& GetCategoryNames() const;
+
+  /** End the current aggregated energy interval and fire the AggregatedEnergyConsumption trace.
+   * - Only used when AggregateEnergyTrace is enabled.
+   *
+   */
+  void EndEnergyInterval();
+
+  /** Called by the DL when the last active slot of a superframe starts.
+   * - Ends the aggregated energy interval when AggregateEnergyTrace is enabled and
+   *   EnergyTraceInterval is zero, so each record covers one superframe.
+   *
+   * @param remainingSlots Number of slots left in the superframe.
+   */
+  void FrameComplete(uint16_t remainingSlots);
+
   /** Prints an energy consumption breakdown.
    *
    * @stream Stream for the output.
@@ -125,13 +208,91 @@ public:
 
 private:
 
+  virtual void DoDispose (void);
+
+  /** Reschedule the depletion event for the current power draw.
+   *
+   */
+  void UpdateDepletionPrediction();
+
+  /** Decrement the energy drawn by a consumer since its last update.
+   *
+   * @param consumer Index of the consumer.
+   */
+  void IntegrateConsumer(uint32_t consumer);
+
+  /** Enable or disable the aggregated energy trace and (re)start the timer.
+   *
+   * @param aggregate True to replace the per decrement trace with aggregated records.
+   */
+  void SetAggregateEnergyTrace(bool aggregate);
+
+  /** Check if the aggregated energy trace is enabled.
+   *
+   */
+  bool GetAggregateEnergyTrace() const;
+
+  /** Set the interval between aggregated energy records and (re)start the timer.
+   *
+   * @param interval Interval, zero to align records with the DL superframes.
+   */
+  void SetEnergyTraceInterval(Time interval);
+
+  /** Get the interval between aggregated energy records.
+   *
+   */
+  Time GetEnergyTraceInterval() const;
+
+  /** Schedule the aggregated energy timer.
+   * - Only runs while AggregateEnergyTrace is enabled, EnergyTraceInterval is positive and the
+   *   battery isn't depleted.
+   */
+  void RestartEnergyTraceTimer();
+
+  /** Timer for aggregated energy records that aren't aligned with the superframes.
+   *
+   */
+  void EnergyTraceTimeout();
+
+  /** Called when the energy source set by SetEnergySource() is depleted.
+   *
+   */
+  void SourceDepleted();
+
+  /** Mark the battery as depleted and notify the trace and depletion callback (only once).
+   *
+   * @param amount Amount of energy in the decrement that caused the depletion (uJ).
+   */
+  void Deplete(double amount);
+
   double m_energy; /// Energy left in battery (uJ).
   double m_initEnergy; /// Initial energy.
-  map<string,double> m_energyBreakdown; /// Breaks out battery energy consumption into different categories.
+  vector<double> m_energyBreakdown; /// Battery energy consumption of each category, indexed by category ID.
+  vector<string> m_categoryNames; /// Name of each category, indexed by category ID.
+  map<string,uint32_t> m_categoryIds; /// ID of each category name.
+  vector<uint32_t> m_categoryConsumer; /// Consumer (SetConsumptionCategories() call) of each category ID.
+
+  bool m_predictDepletion; /// Schedule an event at the predicted time of depletion.
+  vector<double> m_consumerPower; /// Power drawn by each consumer (uJ/s).
+  vector<uint32_t> m_consumerCategory; /// Category ID of the current state of each consumer.
+  vector<Time> m_consumerUpdateTime; /// Time the consumption of each consumer was last decremented.
+  double m_totalPower; /// Total power drawn from the battery (uJ/s).
+  Ptr<Isa100DeviceEnergyModel> m_energyModel; /// Model reporting the power draw to an ns-3 energy source.
+  EventId m_depletionEvent; /// Event scheduled at the predicted time of depletion.
+  bool m_depleted; /// Depletion has been reported.
+  double m_drainedEnergy; /// Energy removed by DrainEnergy() (uJ).
+
+  bool m_aggregateTrace; /// Aggregate the energy consumption trace over intervals.
+  Time m_traceInterval; /// Interval between aggregated records, zero for one record per superframe.
+  Time m_intervalStart; /// Start of the current aggregated interval.
+  vector<double> m_intervalBreakdown; /// Consumption of each category in the current interval, indexed by category ID.
+  EventId m_traceEvent; /// Timer for aggregated records.
 
   Ptr<NetDevice> m_device; /// Pointer to the net device that contains the battery.
+  Mac16Address m_address; /// Cached address of the net device.
 
   BatteryEnergyTraceCallback m_energyConsumptionTrace;  /// Energy consumption trace.
+  BatteryAggregatedEnergyTraceCallback m_aggregatedEnergyTrace;  /// Aggregated energy consumption trace.
   BatteryDepletionCallback m_depletionCallback; /// Depletion callback.
 
 
@@ -0,0 +1,140 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 The University Of Calgary- FISHLAB
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Geoff Messier <gmessier@ucalgary.ca>
+ *
+*/
+
+#include "ns3/isa100-device-energy-model.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+NS_LOG_COMPONENT_DEFINE ("Isa100DeviceEnergyModel");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (Isa100DeviceEnergyModel);
+
+TypeId
+Isa100DeviceEnergyModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Isa100DeviceEnergyModel")
+    .SetParent<DeviceEnergyModel> ()
+    .AddConstructor<Isa100DeviceEnergyModel> ()
+  ;
+  return tid;
+}
+
+Isa100DeviceEnergyModel::Isa100DeviceEnergyModel ()
+{
+  NS_LOG_FUNCTION (this);
+
+  m_power = 0;
+  m_totalEnergy = 0;
+  m_lastUpdateTime = Simulator::Now ();
+}
+
+Isa100DeviceEnergyModel::~Isa100DeviceEnergyModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Isa100DeviceEnergyModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_source = 0;
+  m_depletionCallback = MakeNullCallback<void> ();
+  DeviceEnergyModel::DoDispose ();
+}
+
+void
+Isa100DeviceEnergyModel::SetEnergySource (Ptr<EnergySource> source)
+{
+  NS_LOG_FUNCTION (this << source);
+  NS_ASSERT (source != 0);
+  m_source = source;
+}
+
+double
+Isa100DeviceEnergyModel::GetTotalEnergyConsumption (void) const
+{
+  double pending = m_power * (Simulator::Now () - m_lastUpdateTime).GetSeconds ();
+  return (m_totalEnergy + pending) * 1e-6;
+}
+
+void
+Isa100DeviceEnergyModel::SetPowerDraw (double power)
+{
+  NS_LOG_FUNCTION (this << power);
+
+  // The source integrates the current returned by DoGetCurrentA() so it has to be brought up to
+  // date before the draw changes.
+  if (m_source)
+    m_source->UpdateEnergySource ();
+
+  Time now = Simulator::Now ();
+  m_totalEnergy += m_power * (now - m_lastUpdateTime).GetSeconds ();
+  m_lastUpdateTime = now;
+  m_power = power;
+}
+
+void
+Isa100DeviceEnergyModel::SetDepletionCallback (Isa100EnergySourceDepletionCallback c)
+{
+  m_depletionCallback = c;
+}
+
+void
+Isa100DeviceEnergyModel::ChangeState (int newState)
+{
+  NS_FATAL_ERROR ("Isa100DeviceEnergyModel has no states, the power draw is set by Isa100Battery.");
+}
+
+void
+Isa100DeviceEnergyModel::HandleEnergyDepletion (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_depletionCallback.IsNull ())
+    m_depletionCallback ();
+}
+
+void
+Isa100DeviceEnergyModel::HandleEnergyRecharged (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Isa100DeviceEnergyModel::HandleEnergyChanged (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+double
+Isa100DeviceEnergyModel::DoGetCurrentA (void) const
+{
+  if (!m_source || m_source->GetSupplyVoltage () <= 0)
+    return 0;
+
+  return m_power * 1e-6 / m_source->GetSupplyVoltage ();
+}
+
+} // namespace ns3
@@ -0,0 +1,106 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 The University Of Calgary- FISHLAB
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Geoff Messier <gmessier@ucalgary.ca>
+ *
+ */
+
+
+#ifndef ISA100_DEVICE_ENERGY_MODEL_H
+#define ISA100_DEVICE_ENERGY_MODEL_H
+
+#include "ns3/device-energy-model.h"
+#include "ns3/energy-source.h"
+#include "ns3/nstime.h"
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+/** Callback used when the energy source reports depletion.
+ *
+ */
+typedef Callback< void > Isa100EnergySourceDepletionCallback;
+
+/** Device energy model that connects an Isa100Battery to an ns-3 EnergySource.
+ * - The model has no states of its own.  The battery integrates the draw of the PHY, processor
+ *   and sensor and passes the total to SetPowerDraw() whenever it changes, so the energy source
+ *   sees the same consumption as the battery without a second set of state listeners.
+ * - Created and installed by Isa100Battery::SetEnergySource().
+ */
+class Isa100DeviceEnergyModel : public DeviceEnergyModel
+{
+public:
+
+  static TypeId GetTypeId (void);
+
+  Isa100DeviceEnergyModel ();
+  virtual ~Isa100DeviceEnergyModel ();
+
+  /** Set the energy source the power draw is reported to.
+   *
+   * @param source Pointer to the energy source.
+   */
+  virtual void SetEnergySource (Ptr<EnergySource> source);
+
+  /** Get the energy consumed by the node since the model was created.
+   *
+   * @return Energy (J).
+   */
+  virtual double GetTotalEnergyConsumption (void) const;
+
+  /** Set the total power drawn by the node.
+   * - The energy source is brought up to date with the old draw before the new one takes effect.
+   *
+   * @param power Power (uJ/s).
+   */
+  void SetPowerDraw (double power);
+
+  /** Set the callback used when the energy source is depleted.
+   *
+   * @param c Callback function.
+   */
+  void SetDepletionCallback (Isa100EnergySourceDepletionCallback c);
+
+  /** Not used.  The draw is set by SetPowerDraw().
+   *
+   */
+  virtual void ChangeState (int newState);
+
+  virtual void HandleEnergyDepletion (void);
+  virtual void HandleEnergyRecharged (void);
+  virtual void HandleEnergyChanged (void);
+
+private:
+
+  virtual void DoDispose (void);
+
+  /** Get the current drawn from the energy source.
+   *
+   * @return Current (A).
+   */
+  virtual double DoGetCurrentA (void) const;
+
+  Ptr<EnergySource> m_source; ///< Energy source the draw is reported to.
+  double m_power; ///< Power drawn by the node (uJ/s).
+  double m_totalEnergy; ///< Energy consumed up to m_lastUpdateTime (uJ).
+  Time m_lastUpdateTime; ///< Time of the last change in the power draw.
+  Isa100EnergySourceDepletionCallback m_depletionCallback; ///< Depletion callback.
+};
+
+} // namespace ns3
+
+#endif /* ISA100_DEVICE_ENERGY_MODEL_H */
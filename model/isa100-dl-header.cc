@@ -22,6 +22,7 @@
 
 #include "ns3/isa100-dl-header.h"
 #include "ns3/address-utils.h"
+#include "ns3/assert.h"
 
 
 namespace ns3 {
@@ -49,6 +50,8 @@ Isa100DlHeader::Isa100DlHeader ()
   m_dhdrFrameControl.octet = 0;
 
   /* DROUT Sub-Header */
+  m_priority = 0;
+  m_graphRoute = false;
   m_numRouteAddresses = 0;
 
   for(int iAddr=0; iAddr < ISA100_ROUTE_MAX_HOPS; iAddr++)
@@ -88,6 +91,8 @@ void Isa100DlHeader::Print (std::ostream &os) const
 
   os << ", DMIC-32 = " << m_dmic;
 
+  os << ", Priority = " << static_cast<uint16_t> (m_priority);
+
   os << ", Gen Time = " << m_timeGeneratedNS;
 
 //  os << ", NumRouteAddresses = " << static_cast<uint16_t> (m_numRouteAddresses);
@@ -118,6 +123,19 @@ void Isa100DlHeader::SetSourceRouteHop(uint8_t hopNum, Mac16Address addr)
 
 }
 
+Mac16Address Isa100DlHeader::GetSourceRouteHop(uint8_t hopNum) const
+{
+	if( hopNum >= m_numRouteAddresses)
+		NS_FATAL_ERROR("hopNum exceeds the number of route addresses in the header.");
+
+	return m_routeAddresses[hopNum];
+}
+
+uint8_t Isa100DlHeader::GetNumSourceRouteHops(void) const
+{
+	return m_numRouteAddresses;
+}
+
 Mac16Address Isa100DlHeader::PopNextSourceRoutingHop()
 {
 	Mac16Address nextAddr = m_routeAddresses[0];
@@ -162,7 +180,7 @@ uint32_t Isa100DlHeader::GetSerializedSize (void) const
 
   size += 1; // DHDR frame control
 
-  size += 1; // Number of route addresses.
+  size += 1; // Priority and number of route addresses.
   size += 2*m_numRouteAddresses;  // Storage for route addresses.
 
   size += 2; // DADDR source address
@@ -191,7 +209,7 @@ void Isa100DlHeader::Serialize (Buffer::Iterator start) const
 
   i.WriteU8(m_dhdrFrameControl.octet);
 
-  i.WriteU8(m_numRouteAddresses);
+  i.WriteU8((m_graphRoute ? ISA100_DROUT_GRAPH_ROUTE_FLAG : 0) | (m_priority << ISA100_DROUT_PRIORITY_SHIFT) | m_numRouteAddresses);
 
   for(uint8_t iAddr=0; iAddr < m_numRouteAddresses; iAddr++)
   	WriteTo (i, m_routeAddresses[iAddr]);
@@ -221,7 +239,10 @@ uint32_t Isa100DlHeader::Deserialize (Buffer::Iterator start)
 
   m_dhdrFrameControl.octet = i.ReadU8();
 
-  m_numRouteAddresses = i.ReadU8();
+  uint8_t drout = i.ReadU8();
+  m_graphRoute = drout & ISA100_DROUT_GRAPH_ROUTE_FLAG;
+  m_priority = (drout >> ISA100_DROUT_PRIORITY_SHIFT) & ISA100_DROUT_PRIORITY_MASK;
+  m_numRouteAddresses = drout & ISA100_DROUT_NUM_HOPS_MASK;
 
   for(uint8_t iAddr=0; iAddr < m_numRouteAddresses; iAddr++)
   	ReadFrom(i, m_routeAddresses[iAddr]);
@@ -338,6 +359,27 @@ uint32_t Isa100DlHeader::GetDmic(void) const
   return(m_dmic);
 }
 
+void Isa100DlHeader::SetPriority(uint8_t priority)
+{
+  NS_ASSERT_MSG(priority <= ISA100_DROUT_PRIORITY_MASK, "DROUT priority doesn't fit in 2 bits.");
+  m_priority = priority;
+}
+
+uint8_t Isa100DlHeader::GetPriority(void) const
+{
+  return(m_priority);
+}
+
+void Isa100DlHeader::SetGraphRoute(bool graphRoute)
+{
+  m_graphRoute = graphRoute;
+}
+
+bool Isa100DlHeader::IsGraphRoute(void) const
+{
+  return(m_graphRoute);
+}
+
 void Isa100DlHeader::SetTimeGeneratedNS(uint64_t timeGen)
 {
   m_timeGeneratedNS = timeGen;
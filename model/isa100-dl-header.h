@@ -38,9 +38,20 @@
 
 namespace ns3 {
 
-// This should not exceed 256.
+// This should not exceed 31 since the number of hops shares its DROUT octet with the priority.
 #define ISA100_ROUTE_MAX_HOPS 25
 
+// Layout of the DROUT octet holding the number of route addresses: bit 7 flags a graph route,
+// bits 6-5 are the priority and bits 4-0 the number of route addresses.
+#define ISA100_DROUT_GRAPH_ROUTE_FLAG 0x80
+#define ISA100_DROUT_PRIORITY_SHIFT 5
+#define ISA100_DROUT_PRIORITY_MASK 0x03
+#define ISA100_DROUT_NUM_HOPS_MASK 0x1F
+
+#if ISA100_ROUTE_MAX_HOPS > ISA100_DROUT_NUM_HOPS_MASK
+#error "ISA100_ROUTE_MAX_HOPS does not fit in the DROUT octet."
+#endif
+
 // Prevent the complier from adding padding to the unions larger than 1 byte (this may not be necessary in this case)
 #pragma pack(push,1)
 
@@ -254,7 +265,30 @@ public:
    */
   uint32_t GetDmic(void) const;
 
+  /** Set the DROUT priority of the packet.
+   * - Packed into the octet holding the number of route addresses so it doesn't lengthen the frame.
+   *
+   * @param priority Priority (higher values are more important, 0 to 3).
+   */
+  void SetPriority(uint8_t priority);
+
+  /** Get the DROUT priority of the packet.
+   *
+   * \return Priority.
+   */
+  uint8_t GetPriority(void) const;
+
+  /** Mark the DROUT route entry as a graph ID rather than an address.
+   *
+   * @param graphRoute True if the packet is graph routed.
+   */
+  void SetGraphRoute(bool graphRoute);
 
+  /** Check if the DROUT route entry is a graph ID.
+   *
+   * \return True if the packet is graph routed.
+   */
+  bool IsGraphRoute(void) const;
 
 
 
@@ -273,6 +307,19 @@ public:
    */
   Mac16Address PopNextSourceRoutingHop();
 
+  /** Get a network hop without removing it.
+   *
+   * @param hopNum Index indicating the hop position in the path.
+   * \return Address.
+   */
+  Mac16Address GetSourceRouteHop(uint8_t hopNum) const;
+
+  /** Get the number of addresses in the DROUT sub-header.
+   *
+   * \return Number of route addresses.
+   */
+  uint8_t GetNumSourceRouteHops(void) const;
+
   /* Set the time when the packet was generated
    *
    * @param timeGen time in nanoseconds of packet's origin
@@ -303,6 +350,8 @@ private:
   DhdrFrameControl m_dhdrFrameControl;
 
   // DROUT Sub Header
+  uint8_t m_priority; ///< Packet priority.
+  bool m_graphRoute; ///< The route entry is a graph ID.
   uint8_t m_numRouteAddresses; ///< Number of source routing addresses in DROUT sub-header.
   Mac16Address m_routeAddresses[ISA100_ROUTE_MAX_HOPS]; ///< Source routing address list.
 
@@ -0,0 +1,103 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 The University of Calgary- FISHLAB
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Geoffrey Messier <gmessier@ucalgary.ca>
+ *
+ */
+
+#include "ns3/isa100-dl-neighbor-table.h"
+
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("Isa100DlNeighborTable");
+
+namespace ns3 {
+
+static uint16_t
+AddressKey (Mac16Address addr)
+{
+  uint8_t buffer[2];
+  addr.CopyTo (buffer);
+  return (buffer[0] << 8) | buffer[1];
+}
+
+Isa100DlNeighborTable::Isa100DlNeighborTable ()
+{
+}
+
+uint32_t
+Isa100DlNeighborTable::LowerBound (uint16_t key) const
+{
+  uint32_t low = 0, high = m_keys.size ();
+
+  while (low < high)
+    {
+      uint32_t mid = (low + high) / 2;
+      if (m_keys[mid] < key)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+  return low;
+}
+
+Isa100DlNeighbor*
+Isa100DlNeighborTable::Find (Mac16Address addr)
+{
+  uint16_t key = AddressKey (addr);
+  uint32_t i = LowerBound (key);
+
+  if (i < m_keys.size () && m_keys[i] == key)
+    return &m_entries[i];
+  return 0;
+}
+
+Isa100DlNeighbor*
+Isa100DlNeighborTable::Get (Mac16Address addr)
+{
+  uint16_t key = AddressKey (addr);
+  uint32_t i = LowerBound (key);
+
+  if (i < m_keys.size () && m_keys[i] == key)
+    return &m_entries[i];
+
+  NS_LOG_LOGIC ("Adding neighbour " << addr << " (" << m_keys.size () + 1 << " neighbours)");
+
+  Isa100DlNeighbor neighbor;
+  neighbor.m_txSeqNum = 0;
+  neighbor.m_nextRxSeqNum = 0;
+  neighbor.m_txPowerDbm = ISA100_DL_TX_POWER_UNSET;
+
+  m_keys.insert (m_keys.begin () + i, key);
+  m_entries.insert (m_entries.begin () + i, neighbor);
+  return &m_entries[i];
+}
+
+uint32_t
+Isa100DlNeighborTable::Size (void) const
+{
+  return m_keys.size ();
+}
+
+void
+Isa100DlNeighborTable::Clear (void)
+{
+  m_keys.clear ();
+  m_entries.clear ();
+}
+
+} // namespace ns3
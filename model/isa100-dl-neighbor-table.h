@@ -0,0 +1,94 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 The University of Calgary- FISHLAB
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Geoffrey Messier <gmessier@ucalgary.ca>
+ *
+ */
+
+
+#ifndef ISA100_DL_NEIGHBOR_TABLE_H
+#define ISA100_DL_NEIGHBOR_TABLE_H
+
+#include <vector>
+
+#include "ns3/mac16-address.h"
+
+namespace ns3 {
+
+// Tx power of a neighbour that hasn't been set.
+#define ISA100_DL_TX_POWER_UNSET 100
+
+/** Per neighbour DL state.
+ *
+ */
+struct Isa100DlNeighbor
+{
+  uint8_t m_txSeqNum;  ///< Sequence number of the next packet sent to the neighbour.
+  uint8_t m_nextRxSeqNum;  ///< Sequence number of the next packet expected from the neighbour.
+  int8_t m_txPowerDbm;  ///< Tx power needed to reach the neighbour (dBm), ISA100_DL_TX_POWER_UNSET if not known.
+};
+
+/** Table of DL state for the neighbours of a node, keyed by the full 16 bit address.
+ * - Only nodes the DL has exchanged packets with or been given a tx power for have an entry, so the
+ *   table grows with the node degree rather than the network size.
+ * - Entries are kept sorted by address in a vector and found with a binary search.
+ */
+class Isa100DlNeighborTable
+{
+public:
+
+  Isa100DlNeighborTable ();
+
+  /** Find a neighbour.
+   *
+   * @param addr Neighbour address.
+   * @return Pointer to the entry, 0 if the node isn't in the table.  Only valid until the next Get().
+   */
+  Isa100DlNeighbor* Find (Mac16Address addr);
+
+  /** Get a neighbour, adding it to the table if it isn't there yet.
+   *
+   * @param addr Neighbour address.
+   * @return Pointer to the entry.  Only valid until the next Get().
+   */
+  Isa100DlNeighbor* Get (Mac16Address addr);
+
+  /** Get the number of neighbours in the table.
+   *
+   */
+  uint32_t Size (void) const;
+
+  /** Remove all neighbours.
+   *
+   */
+  void Clear (void);
+
+private:
+
+  /** Get the position of the first entry with an address not less than the key.
+   *
+   * @param key 16 bit address.
+   */
+  uint32_t LowerBound (uint16_t key) const;
+
+  std::vector<uint16_t> m_keys;  ///< Sorted neighbour addresses.
+  std::vector<Isa100DlNeighbor> m_entries;  ///< Neighbour state, same order as m_keys.
+};
+
+} // namespace ns3
+
+#endif /* ISA100_DL_NEIGHBOR_TABLE_H */
@@ -0,0 +1,159 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 The University of Calgary- FISHLAB
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Geoffrey Messier <gmessier@ucalgary.ca>
+ *
+ */
+
+#include "ns3/isa100-dl-tx-queue.h"
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
+
+NS_LOG_COMPONENT_DEFINE ("Isa100DlTxQueue");
+
+namespace ns3 {
+
+Isa100DlTxQueue::Isa100DlTxQueue ()
+{
+  m_head = 0;
+  m_size = 0;
+}
+
+void
+Isa100DlTxQueue::SetCapacity (uint32_t capacity)
+{
+  NS_LOG_FUNCTION (this << capacity);
+
+  if (m_size || m_free.size () != m_pool.size ())
+    NS_FATAL_ERROR ("The DL tx queue capacity can only be changed when the queue is empty.");
+
+  NS_ASSERT (capacity > 0);
+
+  m_pool.assign (capacity + 1, Isa100DlTxQueueElement ());
+  m_free.resize (m_pool.size ());
+  for (uint32_t i = 0; i < m_pool.size (); i++)
+    m_free[i] = &m_pool[i];
+
+  m_ring.assign (capacity, (Isa100DlTxQueueElement *)0);
+  m_head = 0;
+}
+
+uint32_t
+Isa100DlTxQueue::GetCapacity (void) const
+{
+  return m_ring.size ();
+}
+
+Isa100DlTxQueueElement*
+Isa100DlTxQueue::Allocate (void)
+{
+  NS_ASSERT_MSG (!m_free.empty (), "DL tx queue element pool is exhausted.");
+
+  Isa100DlTxQueueElement *element = m_free.back ();
+  m_free.pop_back ();
+  return element;
+}
+
+void
+Isa100DlTxQueue::Release (Isa100DlTxQueueElement *element)
+{
+  element->m_packet = 0;
+  m_free.push_back (element);
+}
+
+uint32_t
+Isa100DlTxQueue::Size (void) const
+{
+  return m_size;
+}
+
+bool
+Isa100DlTxQueue::IsFull (void) const
+{
+  return m_size == m_ring.size ();
+}
+
+Isa100DlTxQueueElement*
+Isa100DlTxQueue::Get (uint32_t i) const
+{
+  NS_ASSERT (i < m_size);
+  return m_ring[(m_head + i) % m_ring.size ()];
+}
+
+Isa100DlTxQueueElement*
+Isa100DlTxQueue::Front (void) const
+{
+  return Get (0);
+}
+
+uint32_t
+Isa100DlTxQueue::Find (Isa100DlTxQueueElement *element) const
+{
+  for (uint32_t i = 0; i < m_size; i++)
+    {
+      if (Get (i) == element)
+        return i;
+    }
+  return m_size;
+}
+
+void
+Isa100DlTxQueue::PushBack (Isa100DlTxQueueElement *element)
+{
+  NS_ASSERT (!IsFull ());
+  m_ring[(m_head + m_size) % m_ring.size ()] = element;
+  m_size++;
+}
+
+void
+Isa100DlTxQueue::PushFront (Isa100DlTxQueueElement *element)
+{
+  NS_ASSERT (!IsFull ());
+  m_head = (m_head + m_ring.size () - 1) % m_ring.size ();
+  m_ring[m_head] = element;
+  m_size++;
+}
+
+void
+Isa100DlTxQueue::PopFront (void)
+{
+  NS_ASSERT (m_size);
+  m_head = (m_head + 1) % m_ring.size ();
+  m_size--;
+}
+
+void
+Isa100DlTxQueue::Remove (uint32_t i)
+{
+  NS_ASSERT (i < m_size);
+
+  // Close the gap by shifting the elements behind it forward.
+  for (uint32_t n = i; n + 1 < m_size; n++)
+    m_ring[(m_head + n) % m_ring.size ()] = m_ring[(m_head + n + 1) % m_ring.size ()];
+  m_size--;
+}
+
+void
+Isa100DlTxQueue::Clear (void)
+{
+  m_head = 0;
+  m_size = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,158 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 The University of Calgary- FISHLAB
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Geoffrey Messier <gmessier@ucalgary.ca>
+ *
+ */
+
+
+#ifndef ISA100_DL_TX_QUEUE_H
+#define ISA100_DL_TX_QUEUE_H
+
+#include <vector>
+
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/mac16-address.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/** Structure for storing a queued packet and associated information.
+ * - The header fields needed on each transmit attempt are decoded once when the packet is queued
+ *   so the DL header doesn't have to be deserialized again.
+ */
+struct Isa100DlTxQueueElement
+{
+  uint8_t m_dsduHandle;
+  uint8_t m_txAttemptsRem;
+  Ptr<Packet> m_packet;
+  bool m_isAck;  ///< Packet is an ACK.
+  bool m_ackReq;  ///< Data packet requests an ACK.
+  uint32_t m_dmic;  ///< DMIC of the data packet (or of the packet being acknowledged), cached when the packet is queued.
+  Mac16Address m_dstAddr;  ///< Next hop address, cached when the packet is queued.
+  Mac16Address m_srcAddr;  ///< Address of the node that originated the packet, cached when the packet is queued.
+  uint8_t m_seqNum;  ///< Sequence number, cached when it is set on the first transmit attempt.
+  uint8_t m_priority;  ///< Priority class (Isa100DlPriority).
+  Time m_enqueueTime;  ///< Time the packet entered the queue.
+};
+
+/** Fixed capacity DL transmit queue.
+ * - Queued elements are held in a ring buffer so adding or removing at either end is O(1).
+ * - Elements are taken from a pool owned by the queue instead of the heap.  The pool holds one
+ *   element more than the capacity so a new element can be filled in before the DL decides
+ *   what to drop when the queue is full.
+ * - The queue doesn't drop anything itself, the DL applies its overflow policy.
+ */
+class Isa100DlTxQueue
+{
+public:
+
+  Isa100DlTxQueue ();
+
+  /** Set the maximum number of queued elements and allocate the pool.
+   * - The queue must be empty and all elements must have been released.
+   *
+   * @param capacity Maximum number of queued elements.
+   */
+  void SetCapacity (uint32_t capacity);
+
+  /** Get the maximum number of queued elements.
+   *
+   */
+  uint32_t GetCapacity (void) const;
+
+  /** Take an element from the pool.
+   *
+   * @return Pointer to an unused element.
+   */
+  Isa100DlTxQueueElement* Allocate (void);
+
+  /** Return an element to the pool.
+   * - The element must not be in the queue.
+   *
+   * @param element Element taken from Allocate().
+   */
+  void Release (Isa100DlTxQueueElement *element);
+
+  /** Get the number of queued elements.
+   *
+   */
+  uint32_t Size (void) const;
+
+  /** Check if the queue is at capacity.
+   *
+   */
+  bool IsFull (void) const;
+
+  /** Get a queued element.
+   *
+   * @param i Position in the queue (0 is the front).
+   */
+  Isa100DlTxQueueElement* Get (uint32_t i) const;
+
+  /** Get the element at the front of the queue.
+   *
+   */
+  Isa100DlTxQueueElement* Front (void) const;
+
+  /** Find the position of an element in the queue.
+   *
+   * @param element Element to find.
+   * @return Position in the queue, Size() if the element isn't queued.
+   */
+  uint32_t Find (Isa100DlTxQueueElement *element) const;
+
+  /** Add an element to the back of the queue.  The queue must not be full.
+   *
+   */
+  void PushBack (Isa100DlTxQueueElement *element);
+
+  /** Add an element to the front of the queue.  The queue must not be full.
+   *
+   */
+  void PushFront (Isa100DlTxQueueElement *element);
+
+  /** Remove the element at the front of the queue.
+   * - The element isn't released.
+   */
+  void PopFront (void);
+
+  /** Remove an element from the queue.
+   * - The element isn't released.
+   *
+   * @param i Position in the queue.
+   */
+  void Remove (uint32_t i);
+
+  /** Remove all elements from the queue.
+   * - The elements aren't released.
+   */
+  void Clear (void);
+
+private:
+
+  std::vector<Isa100DlTxQueueElement> m_pool;  ///< Storage for all elements.
+  std::vector<Isa100DlTxQueueElement*> m_free;  ///< Unused elements in m_pool.
+  std::vector<Isa100DlTxQueueElement*> m_ring;  ///< Ring buffer of queued elements.
+  uint32_t m_head;  ///< Index in m_ring of the front of the queue.
+  uint32_t m_size;  ///< Number of queued elements.
+};
+
+} // namespace ns3
+
+#endif /* ISA100_DL_TX_QUEUE_H */
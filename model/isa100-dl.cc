@@ -31,6 +31,7 @@
 #include "ns3/pointer.h"
 #include "ns3/uinteger.h"
 #include "ns3/integer.h"
+#include "ns3/enum.h"
 #include "ns3/application.h"
 #include <ns3/random-variable-stream.h>
 
@@ -54,6 +55,33 @@ typedef union
   uint8_t byte[2];
 }uTwoBytes_t;
 
+// Descriptions of the DlTaskTrace events, including the meaning of the traced value
+const char * Isa100DlTaskEventNames[] = {"Dl started",
+                                         "Dl ended",
+                                         "Super frame schedule set",
+                                         "Hop to channel (value: channel)",
+                                         "Request that the transceiver state is changed (value: ZigbeePhyEnumeration)",
+                                         "CCA is requested",
+                                         "CCA reported an idle channel",
+                                         "CCA reported a busy channel (value: backoff counter)",
+                                         "Transceiver state TX_ON has been confirmed. Getting ready to transmit the next queued packet.",
+                                         "Woke up from sleep",
+                                         "Phy data request confirmed (value: ZigbeePhyEnumeration)",
+                                         "Phy indicated that data was received (value: SINR dB)",
+                                         "Processed the received data",
+                                         "A request has been made to send data (value: 16 bit destination address)"};
+
+// Descriptions of the DlTxDrop reasons
+const char * Isa100DlTxDropReasonNames[] = {"Retries exhausted",
+                                            "PHY busy",
+                                            "Flushed",
+                                            "Queue overflow"};
+
+// Descriptions of the DL priority classes
+const char * Isa100DlPriorityNames[] = {"Periodic",
+                                        "Control",
+                                        "Alarm"};
+
 
 NS_LOG_COMPONENT_DEFINE ("Isa100Dl");
 
@@ -69,6 +97,8 @@ NS_OBJECT_ENSURE_REGISTERED (Isa100DlSfSchedule);
 Isa100DlSfSchedule::Isa100DlSfSchedule()
 {
   m_currMultiFrameI = 0;
+  m_sfPeriod = 0;
+  m_priority = 0;
 }
 
 void Isa100DlSfSchedule::SetSchedule(
@@ -78,6 +108,7 @@ void Isa100DlSfSchedule::SetSchedule(
 	m_dlHoppingPattern.assign(startHop,startHop+numHop);
 	m_dlLinkScheduleSlots.assign(startSlotSched,startSlotSched+numSlots);
 	m_dlLinkScheduleTypes.assign(startSlotType,startSlotType+numSlots);
+	m_slotActions.clear();
 
 	// One frame superframe
 	m_multiFrameBounds.push_back(0);
@@ -91,6 +122,7 @@ void Isa100DlSfSchedule::SetSchedule(
 	m_dlHoppingPattern = hoppingPattern;
 	m_dlLinkScheduleSlots = scheduleSlots;
 	m_dlLinkScheduleTypes = scheduleTypes;
+	m_slotActions.clear();
 
 	// One frame superframe
 	m_multiFrameBounds.push_back(0);
@@ -112,6 +144,70 @@ std::vector<uint16_t> * Isa100DlSfSchedule::GetFrameBounds(void)
   return &m_multiFrameBounds;
 }
 
+void Isa100DlSfSchedule::Compile(uint16_t sfPeriod)
+{
+	uint32_t numLinks = m_dlLinkScheduleSlots.size();
+	uint32_t numHops = m_dlHoppingPattern.size();
+
+	if(!numLinks || !numHops)
+		NS_FATAL_ERROR("Compiling an empty superframe schedule.");
+	if(m_dlLinkScheduleTypes.size() != numLinks)
+		NS_FATAL_ERROR("Superframe schedule has " << numLinks << " link slots but " << m_dlLinkScheduleTypes.size() << " link types.");
+
+	// Least common multiple of the link and hopping pattern lengths.
+	uint32_t a = numLinks, b = numHops;
+	while(b){
+		uint32_t r = a % b;
+		a = b;
+		b = r;
+	}
+	uint32_t numActions = numLinks / a * numHops;
+
+	m_slotActions.resize(numActions);
+
+	for(uint32_t i=0; i < numActions; i++){
+		uint32_t link = i % numLinks;
+		uint16_t currentSlot = m_dlLinkScheduleSlots[link];
+		uint16_t nextSlot = m_dlLinkScheduleSlots[(link + 1) % numLinks];
+
+		if(currentSlot >= sfPeriod)
+			NS_FATAL_ERROR("Link scheduled in slot " << currentSlot << " of a " << sfPeriod << " slot superframe.");
+
+		Isa100DlSlotAction &action = m_slotActions[i];
+		action.m_slot = currentSlot;
+		action.m_linkType = m_dlLinkScheduleTypes[link];
+		action.m_channel = m_dlHoppingPattern[i % numHops];
+		action.m_superframe = 0;
+		action.m_frameEnd = (nextSlot <= currentSlot);
+		action.m_slotJump = action.m_frameEnd ? (nextSlot + sfPeriod) - currentSlot : nextSlot - currentSlot;
+	}
+}
+
+const std::vector<Isa100DlSlotAction> & Isa100DlSfSchedule::GetSlotActions(void) const
+{
+	return m_slotActions;
+}
+
+void Isa100DlSfSchedule::SetPeriod(uint16_t period)
+{
+	m_sfPeriod = period;
+}
+
+uint16_t Isa100DlSfSchedule::GetPeriod(void) const
+{
+	return m_sfPeriod;
+}
+
+void Isa100DlSfSchedule::SetPriority(uint8_t priority)
+{
+	m_priority = priority;
+}
+
+uint8_t Isa100DlSfSchedule::GetPriority(void) const
+{
+	return m_priority;
+}
+
 Isa100DlSfSchedule::~Isa100DlSfSchedule()
 {
 	;
@@ -122,6 +218,16 @@ TypeId Isa100DlSfSchedule::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::Isa100DlSfSchedule")
     .SetParent<Object> ()
     .AddConstructor<Isa100DlSfSchedule> ()
+
+    .AddAttribute ("Period","Number of timeslots in the superframe (0 uses the DL SuperFramePeriod).",
+    		UintegerValue(0),
+    		MakeUintegerAccessor(&Isa100DlSfSchedule::m_sfPeriod),
+    		MakeUintegerChecker<uint16_t>())
+
+    .AddAttribute ("Priority","Priority of the superframe when it shares a slot with another superframe.",
+    		UintegerValue(0),
+    		MakeUintegerAccessor(&Isa100DlSfSchedule::m_priority),
+    		MakeUintegerChecker<uint8_t>())
     ;
 
     return tid;
@@ -198,6 +304,39 @@ TypeId Isa100Dl::GetTypeId (void)
 				MakeBooleanAccessor (&Isa100Dl::m_ackEnabled),
 				MakeBooleanChecker())
 
+    .AddAttribute ("TxQueueCapacity","Maximum number of packets in the transmit queue.",
+            UintegerValue(64),
+            MakeUintegerAccessor(&Isa100Dl::SetTxQueueCapacity, &Isa100Dl::GetTxQueueCapacity),
+            MakeUintegerChecker<uint32_t>(1))
+
+    .AddAttribute ("TxQueueOverflowPolicy","Packet dropped when the transmit queue is full.",
+            EnumValue(DL_TX_QUEUE_TAIL_DROP),
+            MakeEnumAccessor(&Isa100Dl::m_txQueuePolicy),
+            MakeEnumChecker(DL_TX_QUEUE_TAIL_DROP, "TailDrop",
+                            DL_TX_QUEUE_HEAD_DROP, "HeadDrop",
+                            DL_TX_QUEUE_DROP_OLDEST_DATA, "DropOldestData"))
+
+    .AddAttribute ("TxPriorityService","How the priority class of the next packet sent is chosen.",
+            EnumValue(DL_TX_PRIORITY_STRICT),
+            MakeEnumAccessor(&Isa100Dl::m_txPriorityService),
+            MakeEnumChecker(DL_TX_PRIORITY_STRICT, "Strict",
+                            DL_TX_PRIORITY_WEIGHTED, "Weighted"))
+
+    .AddAttribute ("AlarmServiceWeight","Alarm packets sent per round of weighted priority service.",
+            UintegerValue(4),
+            MakeUintegerAccessor(&Isa100Dl::SetAlarmServiceWeight,&Isa100Dl::GetAlarmServiceWeight),
+            MakeUintegerChecker<uint32_t>())
+
+    .AddAttribute ("ControlServiceWeight","Control packets sent per round of weighted priority service.",
+            UintegerValue(2),
+            MakeUintegerAccessor(&Isa100Dl::SetControlServiceWeight,&Isa100Dl::GetControlServiceWeight),
+            MakeUintegerChecker<uint32_t>())
+
+    .AddAttribute ("PeriodicServiceWeight","Periodic packets sent per round of weighted priority service.",
+            UintegerValue(1),
+            MakeUintegerAccessor(&Isa100Dl::SetPeriodicServiceWeight,&Isa100Dl::GetPeriodicServiceWeight),
+            MakeUintegerChecker<uint32_t>())
+
     .AddTraceSource ("DlTx",
     		"Trace source indicating a packet has arrived for transmission by this device",
     		MakeTraceSourceAccessor (&Isa100Dl::m_dlTxTrace),
@@ -206,7 +345,7 @@ TypeId Isa100Dl::GetTypeId (void)
     .AddTraceSource ("DlTxDrop",
     		"Trace source indicating a packet has been dropped by the device before transmission",
     		MakeTraceSourceAccessor (&Isa100Dl::m_dlTxDropTrace),
-				"ns3::TracedCallback::Packet")
+				"ns3::Isa100Dl::TxDropTracedCallback")
 
     .AddTraceSource ("DlRx",
     		"A packet has been received by this device, has been passed up from the physical layer "
@@ -237,13 +376,28 @@ TypeId Isa100Dl::GetTypeId (void)
     .AddTraceSource("DlTaskTrace",
                     " Trace source tracking Dl tasks",
                     MakeTraceSourceAccessor (&Isa100Dl::m_dlTaskTrace),
-                    "ns3::TracedCallback::DlInfo")
+                    "ns3::Isa100Dl::TaskEventTracedCallback")
 
     .AddTraceSource("RetrxTrace",
                     " Trace source indicating when a retransmission occurs",
                     MakeTraceSourceAccessor (&Isa100Dl::m_retrxTrace),
                     "ns3::TracedCallback::DlInfo")
 
+    .AddTraceSource("TxLatency",
+                    " Trace source with the time each successfully sent data packet spent in the tx queue",
+                    MakeTraceSourceAccessor (&Isa100Dl::m_txLatencyTrace),
+                    "ns3::Isa100Dl::TxLatencyTracedCallback")
+
+    .AddTraceSource("TxReroute",
+                    " Trace source indicating when a data packet is moved to an alternate next hop after a failed transmission",
+                    MakeTraceSourceAccessor (&Isa100Dl::m_txRerouteTrace),
+                    "ns3::Isa100Dl::TxRerouteTracedCallback")
+
+    .AddTraceSource("TxOutcome",
+                    " Trace source with the next hop, attempts and latency of each data packet sent with ACKs",
+                    MakeTraceSourceAccessor (&Isa100Dl::m_txOutcomeTrace),
+                    "ns3::Isa100Dl::TxOutcomeTracedCallback")
+
   ;
   return tid;
 }
@@ -255,18 +409,14 @@ Isa100Dl::Isa100Dl ()
 {
 	NS_LOG_FUNCTION (this);
 
-	m_dlHopIndex = 0;
+	m_currentChannel = 0;
 	m_dlLinkIndex = 0;
+	m_frameSlots = 1;
+	m_timelineSlots = 0;
 	m_expBackoffCounter = 0;
 	m_expArqBackoffCounter = 0;
 	m_tdmaPktsLeft = 0;
 
-	for(int i=0; i<256; i++)
-	{
-	  m_packetTxSeqNum[i] = 0;
-		m_nextRxPacketSeqNum[i] = 0;
-		m_txPowerDbm[i] = 100; // set to an invalid transmit power level
-	}
 	m_usePowerCtrl = 0;
 
 	m_address = Mac16Address::Allocate();
@@ -299,8 +449,22 @@ Isa100Dl::Isa100Dl ()
 	// Logging/results variables
 	m_numFramesSent = 0;
 	m_numRetrx = 0;
+	m_numReroutes = 0;
+	m_attemptedLinksElement = 0;
 	m_numFramesDrop = 0;
 
+	// Rotating from the least important class lands on alarms at the start of the first round.
+	m_alarmWeight = 0;
+	m_controlWeight = 0;
+	m_periodicWeight = 0;
+	m_wrrClass = DL_PRIORITY_PERIODIC;
+	m_wrrCredit = 0;
+	for(uint32_t i=0; i < DL_NUM_PRIORITY_CLASSES; i++){
+		m_priorityTxCount[i] = 0;
+		m_priorityLatencySum[i] = Seconds(0.0);
+		m_priorityLatencyMax[i] = Seconds(0.0);
+	}
+
 }
 
 Isa100Dl::~Isa100Dl ()
@@ -311,28 +475,32 @@ Isa100Dl::~Isa100Dl ()
 void Isa100Dl::Start()
 {
 	NS_LOG_FUNCTION (this);
-	m_dlTaskTrace(m_address, "Dl started");
+	m_dlTaskTrace(m_address, DL_TASK_STARTED, 0);
 
-	if(m_sfSchedule->m_dlLinkScheduleSlots.empty())
+	if(!m_sfSchedule || m_sfSchedule->m_dlLinkScheduleSlots.empty())
 		NS_FATAL_ERROR("No superframe schedule programmed into net device.");
 
+	CompileSfSchedules();
+	m_dlLinkIndex = 0;
+
 	Time clockError = Seconds(m_clockError.GetSeconds() * m_uniformRv->GetValue(0.0,1.0));
 	NS_LOG_LOGIC(" Clock Error: " << clockError.GetSeconds() << "s");
 
-	m_nextProcessLink = Simulator::Schedule(Time(m_sfSlotDuration* (m_sfSchedule->m_dlLinkScheduleSlots[0])) + clockError,&Isa100Dl::ProcessLink,this);
+	m_nextProcessLink = Simulator::Schedule(Time(m_sfSlotDuration* (m_slotActions[0].m_slot)) + clockError,&Isa100Dl::ProcessLink,this);
 }
 
 void Isa100Dl::DoDispose ()
 {
 	NS_LOG_FUNCTION (this);
-  m_dlTaskTrace(m_address, "Dl ended");
+  m_dlTaskTrace(m_address, DL_TASK_ENDED, 0);
 
-  for (uint32_t i = 0; i < m_txQueue.size (); i++)
-    {
-      m_txQueue[i]->m_packet = 0;
-      delete m_txQueue[i];
-    }
-  m_txQueue.clear ();
+  for (uint32_t i = 0; i < m_txQueue.Size (); i++)
+    m_txQueue.Release (m_txQueue.Get (i));
+  m_txQueue.Clear ();
+  m_txDmicIndex.clear ();
+  m_neighbors.Clear ();
+  m_addedSfSchedules.clear ();
+  m_slotActions.clear ();
 
   m_dlDataConfirmCallback = MakeNullCallback< void, DlDataConfirmParams > ();
   m_dlDataIndicationCallback = MakeNullCallback< void, DlDataIndicationParams, Ptr<Packet> > ();
@@ -350,21 +518,140 @@ void Isa100Dl::DoDispose ()
 void Isa100Dl::SetDlSfSchedule(Ptr<Isa100DlSfSchedule> schedule)
 {
 	NS_LOG_FUNCTION (this);
-  m_dlTaskTrace(m_address, "Super frame schedule set");
+  m_dlTaskTrace(m_address, DL_TASK_SCHEDULE_SET, 0);
 
 	m_sfSchedule = schedule;
 }
 
+void Isa100Dl::AddDlSfSchedule(Ptr<Isa100DlSfSchedule> schedule)
+{
+	NS_LOG_FUNCTION (this);
+
+	if(!schedule)
+		NS_FATAL_ERROR("Adding a null superframe schedule.");
+	if(m_addedSfSchedules.size() >= 255)
+		NS_FATAL_ERROR("Too many superframes on one DL.");
+
+	m_addedSfSchedules.push_back(schedule);
+}
 
-void Isa100Dl::ChannelHop()
+uint32_t Isa100Dl::GetNumDlSfSchedules(void) const
+{
+	return (m_sfSchedule ? 1 : 0) + m_addedSfSchedules.size();
+}
+
+Ptr<Isa100DlSfSchedule> Isa100Dl::GetDlSfSchedule(uint32_t index) const
+{
+	NS_ASSERT_MSG(index < GetNumDlSfSchedules(), "Superframe index out of range.");
+
+	return index ? m_addedSfSchedules[index-1] : m_sfSchedule;
+}
+
+Time Isa100Dl::GetTimelinePeriod(void)
+{
+	if(!m_timelineSlots){
+		if(!m_sfSchedule || m_sfSchedule->m_dlLinkScheduleSlots.empty())
+			NS_FATAL_ERROR("No superframe schedule programmed into net device.");
+		CompileSfSchedules();
+	}
+
+	return Time(m_sfSlotDuration * m_timelineSlots);
+}
+
+void Isa100Dl::CompileSfSchedules()
+{
+	NS_LOG_FUNCTION (this);
+
+	std::vector< Ptr<Isa100DlSfSchedule> > schedules;
+	schedules.push_back(m_sfSchedule);
+	schedules.insert(schedules.end(), m_addedSfSchedules.begin(), m_addedSfSchedules.end());
+
+	// Compile each superframe on its own and find how many slots the merged timeline spans before it repeats.
+	std::vector<uint32_t> periods(schedules.size()), cycles(schedules.size());
+	uint64_t timelineSlots = 1;
+
+	for(uint32_t i=0; i < schedules.size(); i++){
+		periods[i] = schedules[i]->m_sfPeriod ? schedules[i]->m_sfPeriod : m_sfPeriod;
+		schedules[i]->Compile(periods[i]);
+
+		const std::vector<Isa100DlSlotAction> &actions = schedules[i]->m_slotActions;
+		uint32_t numFrames = 0;
+		for(uint32_t n=0; n < actions.size(); n++)
+			numFrames += actions[n].m_frameEnd;
+		cycles[i] = periods[i] * numFrames;
+
+		uint64_t a = timelineSlots, b = cycles[i];
+		while(b){
+			uint64_t r = a % b;
+			a = b;
+			b = r;
+		}
+		timelineSlots = timelineSlots / a * cycles[i];
+
+		if(timelineSlots > 0xffffffff)
+			NS_FATAL_ERROR("Merged superframe timeline is too long, choose superframe periods with a smaller common multiple.");
+	}
+
+	// Lay every superframe out over the timeline.  A slot already taken is only given up to a superframe
+	// with a strictly higher priority so, at equal priority, the superframe added first wins.
+	std::map<uint32_t, Isa100DlSlotAction> timeline;
+
+	for(uint32_t i=0; i < schedules.size(); i++){
+		const std::vector<Isa100DlSlotAction> &actions = schedules[i]->m_slotActions;
+		uint8_t priority = schedules[i]->m_priority;
+
+		for(uint64_t cycleStart = 0; cycleStart < timelineSlots; cycleStart += cycles[i]){
+			uint32_t frameStart = cycleStart;
+
+			for(uint32_t n=0; n < actions.size(); n++){
+				Isa100DlSlotAction action = actions[n];
+				action.m_slot += frameStart;
+				action.m_superframe = i;
+
+				if(action.m_frameEnd)
+					frameStart += periods[i];
+
+				std::map<uint32_t, Isa100DlSlotAction>::iterator it = timeline.find(action.m_slot);
+				if(it == timeline.end())
+					timeline.insert(std::make_pair(action.m_slot, action));
+				else if(priority > schedules[it->second.m_superframe]->m_priority){
+					NS_LOG_LOGIC(" Slot " << action.m_slot << " taken from superframe " << (uint32_t)it->second.m_superframe << " by superframe " << i);
+					it->second = action;
+				}
+				else
+					NS_LOG_LOGIC(" Slot " << action.m_slot << " of superframe " << i << " kept by superframe " << (uint32_t)it->second.m_superframe);
+			}
+		}
+	}
+
+	// Flatten the timeline and fill in the jumps.  Frame ends follow the period of superframe 0.
+	m_frameSlots = periods[0];
+	m_timelineSlots = timelineSlots;
+	m_slotActions.clear();
+	m_slotActions.reserve(timeline.size());
+	for(std::map<uint32_t, Isa100DlSlotAction>::iterator it = timeline.begin(); it != timeline.end(); it++)
+		m_slotActions.push_back(it->second);
+
+	for(uint32_t n=0; n < m_slotActions.size(); n++){
+		Isa100DlSlotAction &action = m_slotActions[n];
+		uint64_t nextSlot = (n + 1 < m_slotActions.size()) ? m_slotActions[n+1].m_slot : m_slotActions[0].m_slot + timelineSlots;
+
+		action.m_slotJump = nextSlot - action.m_slot;
+		action.m_frameEnd = (nextSlot / m_frameSlots != action.m_slot / m_frameSlots);
+	}
+
+	NS_LOG_LOGIC(" Merged " << schedules.size() << " superframes into " << m_slotActions.size() << " active slots over " << timelineSlots << " slots.");
+}
+
+
+void Isa100Dl::ChannelHop(uint8_t channelNum)
 {
 	NS_LOG_FUNCTION (this << m_address << Simulator::Now().GetSeconds());
 
-	if(!m_sfSchedule)
-		NS_FATAL_ERROR("Null ISA100 superframe schedule pointer.");
+	if(channelNum == m_currentChannel)
+		return;
 
-	uint32_t scheduleSize = m_sfSchedule->m_dlHoppingPattern.size();
-	uint8_t channelNum = m_sfSchedule->m_dlHoppingPattern[m_dlHopIndex++ % scheduleSize];
+	m_currentChannel = channelNum;
 
 	ZigbeePibAttributeIdentifier id = phyCurrentChannel;
 	ZigbeePhyPIBAttributes attribute;
@@ -373,10 +660,7 @@ void Isa100Dl::ChannelHop()
 
 	NS_LOG_LOGIC (" Hopping to channel " << (uint16_t)channelNum);
 //	Not interested in hopping info right now, uncomment to add functionality
-//  std::stringstream ss;
-//  ss << "Hop to channel " << (uint16_t)channelNum;
-//  std::string msg = ss.str();
-//  m_dlTaskTrace(m_address, msg);
+//  m_dlTaskTrace(m_address, DL_TASK_CHANNEL_HOP, channelNum);
 
 	/*
 	 * A few notes here:
@@ -410,10 +694,7 @@ void Isa100Dl::ProcessTrxStateRequest(ZigbeePhyEnumeration state)
 	}
 
 	// Task log
-  std::stringstream ss;
-  ss << "Request that the transceiver state is changed to " << ZigbeePhyEnumNames[state];
-  std::string msg = ss.str();
-  m_dlTaskTrace(m_address, msg);
+  m_dlTaskTrace(m_address, DL_TASK_TRX_STATE_REQUEST, state);
 
   if(!m_plmeSetTrxStateRequest.IsNull())
     m_plmeSetTrxStateRequest(state);
@@ -427,24 +708,36 @@ void Isa100Dl::ProcessLink()
 
 	NS_LOG_LOGIC(this << " " << m_address << " " << Simulator::Now().GetSeconds());
 
-	if(!m_sfSchedule)
-		NS_FATAL_ERROR("Null ISA100 superframe schedule pointer.");
+	const std::vector<Isa100DlSlotAction> &actions = m_slotActions;
+	NS_ASSERT_MSG(!actions.empty(), "Superframe schedule has not been compiled.");
 
-	// Hop channels
-	ChannelHop();
+	const Isa100DlSlotAction &action = actions[m_dlLinkIndex];
+	if(++m_dlLinkIndex == actions.size())
+		m_dlLinkIndex = 0;
 
-	uint16_t scheduleSize = m_sfSchedule->m_dlLinkScheduleTypes.size();
+	// Schedule the next active slot first so the time to the next slot is valid for the rest of this slot.
+	NS_LOG_LOGIC(" Current Slot Index: " << action.m_slot << " (superframe " << (uint32_t)action.m_superframe << "), process link scheduled " << action.m_slotJump
+			<< " slots into the future (" << Time(m_sfSlotDuration*action.m_slotJump).GetSeconds() << "s in the future)");
 
-	DlLinkType linkType = m_sfSchedule->m_dlLinkScheduleTypes[m_dlLinkIndex % scheduleSize];
+	m_nextProcessLink = Simulator::Schedule(Time(m_sfSlotDuration*action.m_slotJump),&Isa100Dl::ProcessLink,this);
+
+	// Hop channels
+	ChannelHop(action.m_channel);
+
+	DlLinkType linkType = (DlLinkType)action.m_linkType;
 
 	NS_LOG_LOGIC(" Link Type: " << linkType);
 
   // Trace process link
-  m_processLinkTrace(m_address, linkType, m_txQueue.size(), m_expBackoffCounter, m_expArqBackoffCounter);
+  m_processLinkTrace(m_address, linkType, m_txQueue.Size(), m_expBackoffCounter, m_expArqBackoffCounter);
+
+  // Pick the packet this slot is used for.
+  if(m_txQueue.Size() && (linkType == TRANSMIT || (linkType == SHARED && !m_expBackoffCounter)))
+  	SelectTxElement();
 
   // Receive if this is a dedicated receive slot or if it's shared and we have
   // nothing to send.
-  if(linkType == RECEIVE || (linkType == SHARED && !m_txQueue.size())){
+  if(linkType == RECEIVE || (linkType == SHARED && !m_txQueue.Size())){
 
     NS_LOG_LOGIC(" Setting PHY to Rx On for a single slot.");
 
@@ -453,23 +746,32 @@ void Isa100Dl::ProcessLink()
 
 
   // We can only transmit if there's a packet in the queue and we're not in backoff.
-  if(linkType == SHARED && m_txQueue.size() && !m_expBackoffCounter){
+  if(linkType == SHARED && m_txQueue.Size() && !m_expBackoffCounter){
   	NS_LOG_LOGIC(" Packet to transmit on shared link, requesting CCA in " << m_xmitEarliest.GetSeconds() << "s");
   	Simulator::Schedule(m_xmitEarliest,&Isa100Dl::CallPlmeCcaRequest,this);
   }
 
   if(linkType == TRANSMIT){
-    NS_LOG_LOGIC(" Setting PHY to Tx On.");
 
     if(m_expBackoffCounter){
       NS_LOG_LOGIC(" Zeroing backoff counter since we are now in a dedicated transmit slot.");
       m_expBackoffCounter = 0;
     }
 
-    if(m_xmitEarliest == Seconds(0.0))
+    // With nothing to send the transmitter would only be switched on to be turned off again, so do
+    // that directly instead of scheduling the transmit.
+    if(!m_txQueue.Size()){
+      NS_LOG_LOGIC(" Nothing to transmit, TRX Off.");
+      ProcessTrxStateRequest(IEEE_802_15_4_PHY_TRX_OFF);
+    }
+    else if(m_xmitEarliest == Seconds(0.0)){
+      NS_LOG_LOGIC(" Setting PHY to Tx On.");
     	ProcessTrxStateRequest(IEEE_802_15_4_PHY_TX_ON);
-    else
+    }
+    else{
+      NS_LOG_LOGIC(" Setting PHY to Tx On in " << m_xmitEarliest.GetSeconds() << "s");
     	Simulator::Schedule(m_xmitEarliest, &Isa100Dl::ProcessTrxStateRequest, this,IEEE_802_15_4_PHY_TX_ON);
+    }
   }
 
 
@@ -478,28 +780,16 @@ void Isa100Dl::ProcessLink()
     NS_LOG_LOGIC(" Decrementing backoff counter, value:" << m_expBackoffCounter);
   }
 
-	uint16_t currentSlot = m_sfSchedule->m_dlLinkScheduleSlots[m_dlLinkIndex++ % scheduleSize];
-	uint16_t nextSlot = m_sfSchedule->m_dlLinkScheduleSlots[m_dlLinkIndex % scheduleSize];
-	uint16_t slotJump;
-
-	NS_LOG_LOGIC(" Current Slot Index: " << currentSlot << " Next Slot Index: " << nextSlot);
-
-	if(nextSlot <= currentSlot)
-		slotJump = (nextSlot + m_sfPeriod)- currentSlot;
-	else
-		slotJump = nextSlot - currentSlot;
-
-	NS_LOG_LOGIC(" Process link scheduled " << slotJump << " slots into the future ("
-	             << Time(m_sfSlotDuration*slotJump).GetSeconds() << "s in the future)");
-
-	m_nextProcessLink = Simulator::Schedule(Time(m_sfSlotDuration*slotJump),&Isa100Dl::ProcessLink,this);
+	// The schedule wraps after the last active slot of the superframe.
+	if(action.m_frameEnd && !m_dlFrameCompleteCallback.IsNull())
+		m_dlFrameCompleteCallback(m_frameSlots - action.m_slot % m_frameSlots - 1);
 
 
   // If there are upcoming idle slots turn off the transceiver for them
 	// Note that the transceiver is under the control of the processor but the processor doesn't have visibility
 	// into the superframe schedule.  So, we assume the protocol stack is smart enough to put the transceiver to sleep in
 	// idle slots.
-  if (slotJump > 1)
+  if (action.m_slotJump > 1)
   {
   	if(m_dlSleepEnabled){
       NS_LOG_LOGIC(" PHY_SLEEP in " << m_sfSlotDuration.GetSeconds() << "s");
@@ -517,7 +807,7 @@ void Isa100Dl::CallPlmeCcaRequest()
 	NS_LOG_FUNCTION(this << m_address << Simulator::Now().GetSeconds());
 
   // Task log
-  m_dlTaskTrace(m_address, "CCA is requested");
+  m_dlTaskTrace(m_address, DL_TASK_CCA_REQUEST, 0);
 
 	if(!m_plmeCcaRequest.IsNull())
 		m_plmeCcaRequest();
@@ -552,6 +842,213 @@ bool Isa100Dl::IsAckPacket(Ptr<const Packet> p)
   return true;
 }
 
+void Isa100Dl::IndexTxElement(TxQueueElement *element)
+{
+	if(m_ackEnabled)
+		m_txDmicIndex.insert(std::make_pair(element->m_dmic, element));
+}
+
+void Isa100Dl::DeleteTxElement(TxQueueElement *element)
+{
+	std::pair<std::multimap<uint32_t, TxQueueElement*>::iterator, std::multimap<uint32_t, TxQueueElement*>::iterator> range;
+	range = m_txDmicIndex.equal_range(element->m_dmic);
+
+	for(std::multimap<uint32_t, TxQueueElement*>::iterator it = range.first; it != range.second; it++){
+		if(it->second == element){
+			m_txDmicIndex.erase(it);
+			break;
+		}
+	}
+
+	if(element == m_attemptedLinksElement){
+		m_attemptedLinks.clear();
+		m_attemptedLinksElement = 0;
+	}
+
+	m_txQueue.Release(element);
+}
+
+bool Isa100Dl::EnqueueTxElement(TxQueueElement *element, bool front)
+{
+	if(m_txQueue.IsFull()){
+
+		// The front of the queue may be in the middle of a transmission so it is never dropped.
+		uint32_t dropInd = m_txQueue.Size();
+
+		// Dropping an ACK only makes the sender retransmit, so the newest data packet makes room instead.
+		if(element->m_isAck){
+			for(uint32_t i=m_txQueue.Size(); i-- > 1; ){
+				if(!m_txQueue.Get(i)->m_isAck){
+					dropInd = i;
+					break;
+				}
+			}
+		}
+
+		else if(m_txQueuePolicy == DL_TX_QUEUE_HEAD_DROP && m_txQueue.Size() > 1)
+			dropInd = 1;
+
+		else if(m_txQueuePolicy == DL_TX_QUEUE_DROP_OLDEST_DATA){
+			for(uint32_t i=1; i < m_txQueue.Size(); i++){
+				if(!m_txQueue.Get(i)->m_isAck){
+					dropInd = i;
+					break;
+				}
+			}
+		}
+
+		NS_LOG_LOGIC(" Tx queue full (" << m_txQueue.Size() << " packets), dropping "
+				<< (dropInd < m_txQueue.Size() ? "queued" : "new") << " packet.");
+
+		if(dropInd == m_txQueue.Size()){
+			DropTxElement(element, DL_TX_DROP_QUEUE_OVERFLOW, "Dl Tx Queue is full.");
+			return false;
+		}
+
+		TxQueueElement *dropElement = m_txQueue.Get(dropInd);
+		m_txQueue.Remove(dropInd);
+		DropTxElement(dropElement, DL_TX_DROP_QUEUE_OVERFLOW, "Packet was pushed out of the full Dl Tx Queue.");
+	}
+
+	element->m_enqueueTime = Simulator::Now();
+
+	if(front)
+		m_txQueue.PushFront(element);
+	else
+		m_txQueue.PushBack(element);
+
+	if(!element->m_isAck)
+		IndexTxElement(element);
+
+	return true;
+}
+
+void Isa100Dl::DropTxElement(TxQueueElement *element, Isa100DlTxDropReason reason, std::string msg)
+{
+	m_dlTxDropTrace(m_address,element->m_packet,reason);
+	m_infoDropTrace(m_address,element->m_packet,msg);
+	m_numFramesDrop++;
+
+	DlDataConfirmParams params;
+	params.m_dsduHandle = element->m_dsduHandle;
+	params.m_status = FAILURE;
+	bool localPacket = !element->m_isAck && element->m_srcAddr == m_address;
+
+	DeleteTxElement(element);
+
+	if(localPacket && !m_dlDataConfirmCallback.IsNull())
+		m_dlDataConfirmCallback(params);
+}
+
+void Isa100Dl::SelectTxElement(void)
+{
+	TxQueueElement *front = m_txQueue.Front();
+
+	// Don't interrupt an ACK or a packet waiting on its own ACK/retransmission.
+	if(front->m_isAck || (m_ackEnabled && front->m_txAttemptsRem != m_maxFrameRetries + 1))
+		return;
+
+	// Position of the oldest packet in each class.
+	uint32_t classInd[DL_NUM_PRIORITY_CLASSES];
+	for(uint32_t c=0; c < DL_NUM_PRIORITY_CLASSES; c++)
+		classInd[c] = m_txQueue.Size();
+
+	for(uint32_t i=m_txQueue.Size(); i-- > 0; )
+		classInd[m_txQueue.Get(i)->m_priority] = i;
+
+	uint32_t selInd = m_txQueue.Size();
+
+	if(m_txPriorityService == DL_TX_PRIORITY_STRICT){
+		for(uint32_t c=DL_NUM_PRIORITY_CLASSES; c-- > 0 && selInd == m_txQueue.Size(); )
+			selInd = classInd[c];
+	}
+	else{
+		uint32_t weight[DL_NUM_PRIORITY_CLASSES];
+		weight[DL_PRIORITY_PERIODIC] = m_periodicWeight;
+		weight[DL_PRIORITY_CONTROL] = m_controlWeight;
+		weight[DL_PRIORITY_ALARM] = m_alarmWeight;
+
+		// Serve the current class until its credit runs out or it has nothing queued, then move on
+		// to the next less important class (wrapping back to alarms).  The credit is only used once the
+		// packet is actually transmitted.
+		for(uint32_t n=0; n <= DL_NUM_PRIORITY_CLASSES; n++){
+			if(m_wrrCredit && classInd[m_wrrClass] < m_txQueue.Size()){
+				selInd = classInd[m_wrrClass];
+				break;
+			}
+			m_wrrClass = m_wrrClass ? m_wrrClass - 1 : DL_NUM_PRIORITY_CLASSES - 1;
+			m_wrrCredit = weight[m_wrrClass];
+		}
+	}
+
+	if(selInd == 0 || selInd == m_txQueue.Size())
+		return;
+
+	NS_LOG_LOGIC(" Serving " << Isa100DlPriorityNames[m_txQueue.Get(selInd)->m_priority]
+			<< " packet at tx queue position " << selInd);
+
+	TxQueueElement *element = m_txQueue.Get(selInd);
+	m_txQueue.Remove(selInd);
+	m_txQueue.PushFront(element);
+}
+
+void Isa100Dl::RecordTxLatency(TxQueueElement *element)
+{
+	Time latency = Simulator::Now() - element->m_enqueueTime;
+	uint8_t priority = element->m_priority;
+
+	m_priorityTxCount[priority]++;
+	m_priorityLatencySum[priority] += latency;
+	if(latency > m_priorityLatencyMax[priority])
+		m_priorityLatencyMax[priority] = latency;
+
+	m_txLatencyTrace(m_address, (Isa100DlPriority)priority, latency);
+
+	if(m_ackEnabled)
+		RecordTxOutcome(element, true);
+}
+
+void Isa100Dl::RecordTxOutcome(TxQueueElement *element, bool success)
+{
+	uint8_t attempts = m_maxFrameRetries + 1 - element->m_txAttemptsRem;
+	m_txOutcomeTrace(m_address, element->m_dstAddr, success, attempts, Simulator::Now() - element->m_enqueueTime);
+}
+
+void Isa100Dl::RerouteTxElement(TxQueueElement *element)
+{
+	NS_LOG_FUNCTION(this << m_address);
+
+	// Start a new list of attempted links when a different packet reaches the retransmission stage.
+	if(element != m_attemptedLinksElement){
+		m_attemptedLinks.clear();
+		m_attemptedLinksElement = element;
+	}
+
+	if(std::find(m_attemptedLinks.begin(), m_attemptedLinks.end(), element->m_dstAddr) == m_attemptedLinks.end())
+		m_attemptedLinks.push_back(element->m_dstAddr);
+
+	Isa100DlHeader header;
+	element->m_packet->PeekHeader(header);
+
+	Mac16Address nextHop = m_routingAlgorithm->AttemptAnotherLink(header.GetDaddrDestAddress(), m_attemptedLinks);
+	if(nextHop == Mac16Address("ff:ff"))
+		return;
+
+	NS_LOG_LOGIC(" Transmission to " << element->m_dstAddr << " failed, rerouting through " << nextHop);
+
+	m_txRerouteTrace(m_address, element->m_packet, element->m_dstAddr, nextHop);
+	m_numReroutes++;
+
+	// The new neighbour has its own sequence numbers.
+	element->m_packet->RemoveHeader(header);
+	header.SetDstAddrFields(0,nextHop);
+	header.SetSeqNum(m_neighbors.Get(nextHop)->m_txSeqNum++);
+	element->m_packet->AddHeader(header);
+
+	element->m_dstAddr = nextHop;
+	element->m_seqNum = header.GetSeqNum();
+}
+
 void Isa100Dl::PlmeCcaConfirm(ZigbeePhyEnumeration status)
 {
 	NS_LOG_FUNCTION (this << m_address << Simulator::Now().GetSeconds());
@@ -560,10 +1057,10 @@ void Isa100Dl::PlmeCcaConfirm(ZigbeePhyEnumeration status)
 	if(status == IEEE_802_15_4_PHY_IDLE){
 		NS_LOG_LOGIC(" CCA indicates idle channel, turning Tx on.");
 
-		m_dlTaskTrace(m_address, "CCA reported an idle channel");
+		m_dlTaskTrace(m_address, DL_TASK_CCA_IDLE, 0);
 
 		// Make sure queue hasn't been flushed during cca
-		if (m_txQueue.size() != 0){
+		if (m_txQueue.Size() != 0){
 		  ProcessTrxStateRequest((ZigbeePhyEnumeration)IEEE_802_15_4_PHY_TX_ON);
 		}
 	}
@@ -574,10 +1071,7 @@ void Isa100Dl::PlmeCcaConfirm(ZigbeePhyEnumeration status)
 		NS_LOG_LOGIC(" CCA indicates busy channel, starting backoff.");
 
 		// Task log
-    std::stringstream ss;
-    ss << "CCA reported a busy channel. Backoff counter set to " << m_expBackoffCounter;
-    std::string msg = ss.str();
-    m_dlTaskTrace(m_address, msg);
+    m_dlTaskTrace(m_address, DL_TASK_CCA_BUSY, m_expBackoffCounter);
 
     // Put the transceiver into RX while in backoff
     ProcessTrxStateRequest((ZigbeePhyEnumeration)IEEE_802_15_4_PHY_RX_ON);
@@ -594,49 +1088,38 @@ void Isa100Dl::PlmeSetTrxStateConfirm(ZigbeePhyEnumeration status)
 	if(status == IEEE_802_15_4_PHY_TX_ON)
 	{
     NS_LOG_LOGIC(" Set TRX state confirmed (Tx on): " << status);
-    m_dlTaskTrace(m_address, "Transceiver state TX_ON has been confirmed. Getting ready to transmit the next queued packet.");
+    m_dlTaskTrace(m_address, DL_TASK_TX_ON_CONFIRMED, 0);
 
-    if(m_txQueue.size() == 0)
+    if(m_txQueue.Size() == 0)
     {
     	// If nothing to transmit, then turn off the transceiver
     	ProcessTrxStateRequest(IEEE_802_15_4_PHY_TRX_OFF);
     	return;
     }
-    NS_LOG_DEBUG(" " << m_txQueue.size() << " packets to transmit.");
-
+    NS_LOG_DEBUG(" " << m_txQueue.Size() << " packets to transmit.");
 
-    TxQueueElement *txQElement = m_txQueue.front ();
 
-    Mac16Address nextNodeAddr;
-    uTwoBytes_t buffer;
-    uint8_t nextNodeInd;
+    TxQueueElement *txQElement = m_txQueue.Front ();
 
-    if(IsAckPacket(txQElement->m_packet)){
-    	Isa100DlAckHeader ackHdr;
-    	txQElement->m_packet->PeekHeader(ackHdr);
-    	nextNodeAddr = ackHdr.GetShortDstAddr();
-    }
-    else{
-    	Isa100DlHeader header;
-    	txQElement->m_packet->PeekHeader(header);
-    	nextNodeAddr = header.GetShortDstAddr();
-    }
+    // A data packet about to be retransmitted tries an alternate next hop before spending more attempts on
+    // the link that just failed.
+    if(m_ackEnabled && m_routingAlgorithm && !txQElement->m_isAck && !m_expArqBackoffCounter
+    		&& txQElement->m_txAttemptsRem && txQElement->m_txAttemptsRem != m_maxFrameRetries + 1)
+    	RerouteTxElement(txQElement);
 
-
-    nextNodeAddr.CopyTo(buffer.byte);
-    nextNodeInd = buffer.byte[1];
+    Mac16Address nextNodeAddr = txQElement->m_dstAddr;
 
     if(m_usePowerCtrl){
 
     	// Obtain and format tx power for PHY layer
-    	int8_t txPower = m_txPowerDbm[nextNodeInd];
+    	int8_t txPower = GetTxPowerDbm(nextNodeAddr);
 
   		ZigbeePibAttributeIdentifier id = phyTransmitPower;
   		ZigbeePhyPIBAttributes attribute;
 
   		attribute.phyTransmitPower = txPower;
 
-    	NS_LOG_DEBUG(" Tx Power Control " << m_address << " -> " << nextNodeAddr << "(" << (int)nextNodeInd << "): " << (int)txPower << "dBm");
+    	NS_LOG_DEBUG(" Tx Power Control " << m_address << " -> " << nextNodeAddr << ": " << (int)txPower << "dBm");
 
   		// Set the tx power attribute
   		if(!m_plmeSetAttribute.IsNull())
@@ -679,7 +1162,7 @@ void Isa100Dl::PlmeSetTrxStateConfirm(ZigbeePhyEnumeration status)
     // turn on.  Shouldn't this be done in ProcessLink?
 
 
-    if(m_expArqBackoffCounter > 0 && !IsAckPacket(txQElement->m_packet))
+    if(m_expArqBackoffCounter > 0 && !txQElement->m_isAck)
     {
     	m_expArqBackoffCounter--;
 
@@ -694,18 +1177,18 @@ void Isa100Dl::PlmeSetTrxStateConfirm(ZigbeePhyEnumeration status)
 
     	NS_LOG_LOGIC(" Packet could not be transmitted after " << m_maxFrameRetries << " retries. Drop packet.");
 
-    	m_dlTxDropTrace(m_address,m_txQueue.front()->m_packet);
-    	m_infoDropTrace(m_address,m_txQueue.front()->m_packet, "Dl exhausted all possible links and transmit attempts for this packet.");
+    	m_dlTxDropTrace(m_address,m_txQueue.Front()->m_packet,DL_TX_DROP_RETRIES_EXHAUSTED);
+    	m_infoDropTrace(m_address,m_txQueue.Front()->m_packet, "Dl exhausted all possible links and transmit attempts for this packet.");
     	m_numFramesDrop++;
+    	RecordTxOutcome(txQElement, false);
 
     	// Inform the upper layer of a failure
     	DlDataConfirmParams params;
     	params.m_dsduHandle = txQElement->m_dsduHandle;
     	params.m_status = FAILURE;
 
-    	txQElement->m_packet = 0;
-    	delete txQElement;
-    	m_txQueue.pop_front ();
+    	m_txQueue.PopFront ();
+    	DeleteTxElement(txQElement);
 
     	if(!m_dlDataConfirmCallback.IsNull())
     		m_dlDataConfirmCallback(params);
@@ -714,7 +1197,7 @@ void Isa100Dl::PlmeSetTrxStateConfirm(ZigbeePhyEnumeration status)
     }
 
     // The first attempt of sending a data packet
-    else if(!m_ackEnabled || ( !IsAckPacket(txQElement->m_packet) && (txQElement->m_txAttemptsRem == m_maxFrameRetries + 1) ) )
+    else if(!m_ackEnabled || ( !txQElement->m_isAck && (txQElement->m_txAttemptsRem == m_maxFrameRetries + 1) ) )
     {
 
     	NS_LOG_DEBUG(" First packet transmit attempt.");
@@ -726,8 +1209,12 @@ void Isa100Dl::PlmeSetTrxStateConfirm(ZigbeePhyEnumeration status)
 
     	// Set the sequence number
     	txQElement->m_packet->RemoveHeader(header);
-    	header.SetSeqNum(m_packetTxSeqNum[nextNodeInd]++);
+    	header.SetSeqNum(m_neighbors.Get(nextNodeAddr)->m_txSeqNum++);
     	txQElement->m_packet->AddHeader(header);
+    	txQElement->m_seqNum = header.GetSeqNum();
+
+    	if(!txQElement->m_isAck)
+    		ChargeWeightedService(txQElement->m_priority);
 
     	if(m_ackEnabled){
     		// Decrement transmit attempts remaining for the packet
@@ -742,7 +1229,7 @@ void Isa100Dl::PlmeSetTrxStateConfirm(ZigbeePhyEnumeration status)
     }
 
     // This is a retransmission attempt of a data packet
-    else if (m_ackEnabled && !IsAckPacket(txQElement->m_packet))
+    else if (m_ackEnabled && !txQElement->m_isAck)
     {
     	NS_LOG_DEBUG(" Data packet retransmission attempt. " << txQElement->m_txAttemptsRem << " retries remaining.");
 
@@ -760,7 +1247,7 @@ void Isa100Dl::PlmeSetTrxStateConfirm(ZigbeePhyEnumeration status)
     }
 
     // This is the first attempt of an ACK packet
-    else if ( IsAckPacket(txQElement->m_packet) )
+    else if ( txQElement->m_isAck )
     {
     	NS_LOG_DEBUG(" ACK packet sent. " << txQElement->m_txAttemptsRem << " attempts remaining.");
 
@@ -796,7 +1283,7 @@ void Isa100Dl::PlmeWakeUp (void)
 
   if(!m_dlWokeUpCallback.IsNull()){
     NS_LOG_LOGIC("DL Layer on Node " << m_address << " is awake once again at time: " << Simulator::Now());
-    m_dlTaskTrace(m_address, "Woke up from sleep");
+    m_dlTaskTrace(m_address, DL_TASK_WOKE_UP, 0);
     m_dlWokeUpCallback();
   }
 }
@@ -807,25 +1294,21 @@ void Isa100Dl::PdDataConfirm(ZigbeePhyEnumeration status)
 	NS_LOG_FUNCTION (this << m_address << Simulator::Now().GetSeconds());
 
   // Task log
-  std::stringstream ss;
-  ss << "Phy data request confirmed with status " << ZigbeePhyEnumNames[status];
-  std::string msg = ss.str();
-  m_dlTaskTrace(m_address, msg);
+  m_dlTaskTrace(m_address, DL_TASK_PD_DATA_CONFIRM, status);
 
 	DlDataConfirmParams params;
 
-  TxQueueElement *txQElement = m_txQueue.front ();
+  TxQueueElement *txQElement = m_txQueue.Front ();
 
 	if(status == IEEE_802_15_4_PHY_SUCCESS)
 	{
 		if(m_ackEnabled)
 		{
 			// Check if packet is an ACK
-			if (IsAckPacket (txQElement->m_packet))
+			if (txQElement->m_isAck)
 			{
-				txQElement->m_packet = 0;
-				delete txQElement;
-				m_txQueue.pop_front ();
+				m_txQueue.PopFront ();
+				DeleteTxElement(txQElement);
 
 				// ACKs are only sent during RX or SHARED slots, so the transceiver
 				// should be put back to RX_ON now that the ACK has sent
@@ -837,10 +1320,7 @@ void Isa100Dl::PdDataConfirm(ZigbeePhyEnumeration status)
 			else
 			{
 				// Check if we are expecting an ACK
-				Isa100DlHeader header;
-				txQElement->m_packet->PeekHeader(header);
-
-				if (header.GetDhdrFrameControl().ackReq == 1)
+				if (txQElement->m_ackReq)
 				{
 					// Expecting to receive an ACK; don't remove the packet yet
 					// Set the TRX to receive
@@ -854,15 +1334,14 @@ void Isa100Dl::PdDataConfirm(ZigbeePhyEnumeration status)
 		params.m_dsduHandle = txQElement->m_dsduHandle;
 		params.m_status = SUCCESS;
 
-		Isa100DlHeader dataHdr;
-		txQElement->m_packet->PeekHeader(dataHdr);
+		bool localPacket = (txQElement->m_srcAddr == m_address);
 
-		txQElement->m_packet = 0;
-		delete txQElement;
-		m_txQueue.pop_front ();
+		RecordTxLatency(txQElement);
+		m_txQueue.PopFront ();
+		DeleteTxElement(txQElement);
 
 		// Only confirm to higher layer if the packet originated at this node
-		if (dataHdr.GetDaddrSrcAddress() == m_address)
+		if (localPacket)
 		{
 			if(!m_dlDataConfirmCallback.IsNull())
 				m_dlDataConfirmCallback(params);
@@ -888,7 +1367,7 @@ void Isa100Dl::PdDataConfirm(ZigbeePhyEnumeration status)
 	// If transmitter is busy, the PHY is being overwhelmed and the packet is dropped.
 	else{
 
-		m_dlTxDropTrace(m_address,txQElement->m_packet);
+		m_dlTxDropTrace(m_address,txQElement->m_packet,DL_TX_DROP_PHY_BUSY);
     m_infoDropTrace(m_address,txQElement->m_packet, "PHY is busy transmitting another packet.");
 		m_numFramesDrop++;
 
@@ -898,9 +1377,8 @@ void Isa100Dl::PdDataConfirm(ZigbeePhyEnumeration status)
     params.m_dsduHandle = txQElement->m_dsduHandle;
     params.m_status = FAILURE;
 
-    txQElement->m_packet = 0;
-    delete txQElement;
-    m_txQueue.pop_front ();
+    m_txQueue.PopFront ();
+    DeleteTxElement(txQElement);
 
     if(!m_dlDataConfirmCallback.IsNull())
     	m_dlDataConfirmCallback(params);
@@ -916,10 +1394,7 @@ void Isa100Dl::PdDataIndication(uint32_t size, Ptr<Packet> p, uint32_t lqi, doub
   NS_LOG_FUNCTION (this << size << p << lqi << m_address << Simulator::Now().GetSeconds());
 
   // Task log
-  std::stringstream ss;
-  ss << "Phy indicated that data was received with an SINR of " << 10*log10(lqi) << " dB";
-  std::string msg = ss.str();
-  m_dlTaskTrace(m_address, msg);
+  m_dlTaskTrace(m_address, DL_TASK_PD_DATA_INDICATION, 10*log10(lqi));
 
   Time delay = m_minLIFSPeriod;
 
@@ -933,7 +1408,7 @@ void Isa100Dl::PdDataIndication(uint32_t size, Ptr<Packet> p, uint32_t lqi, doub
 void Isa100Dl::ProcessPdDataIndication(uint32_t size, Ptr<Packet> p, uint32_t lqi, double rxPowDbm)
 {
   NS_LOG_FUNCTION (this << size << *p << lqi << m_address << Simulator::Now().GetSeconds());
-  m_dlTaskTrace(m_address, "Processed the received data");
+  m_dlTaskTrace(m_address, DL_TASK_RX_PROCESSED, 0);
 
 
   if (m_ackEnabled && IsAckPacket (p))
@@ -945,57 +1420,43 @@ void Isa100Dl::ProcessPdDataIndication(uint32_t size, Ptr<Packet> p, uint32_t lq
   	uint32_t ackDmic = ackHdr.GetDmic();
 
   	// If that packet is in the tx queue, it can be removed
-  	std::deque<TxQueueElement*>::iterator it = m_txQueue.begin();
+  	std::multimap<uint32_t, TxQueueElement*>::iterator indexIt = m_txDmicIndex.find(ackDmic);
 
-  	while (it != m_txQueue.end())
+  	if (indexIt != m_txDmicIndex.end())
   	{
-  		Ptr<Packet> currPacket = (*it)->m_packet;
-  		if (IsAckPacket(currPacket))
-  		{
-  			it++;
-  			continue;
-  		}
-  		Isa100DlHeader dataHdr;
-  		currPacket->PeekHeader(dataHdr);
-  		uint32_t dmic = dataHdr.GetDmic();
-  		if (dmic == ackDmic)
-  		{
-  			// Found Ack'd packet
-  			// Clear the arq backoff counter
-  			m_expArqBackoffCounter = 0;
-
-  			// Increment seq number
-  			uint8_t buffer[2];
-  			Mac16Address destAddr = dataHdr.GetShortDstAddr();
-  			destAddr.CopyTo(buffer);
-  			uint8_t destNodeInd = buffer[1];
-
-  			m_packetTxSeqNum[destNodeInd] = dataHdr.GetSeqNum() + 1;
-
-  			DlDataConfirmParams params;
-  			params.m_dsduHandle = (*it)->m_dsduHandle;
-  			params.m_status = SUCCESS;
-
-  			// Remove queue item
-  			(*it)->m_packet = 0;
-  			delete *it;
-  			m_txQueue.erase(it);
-
-  			// Only confirm to higher layer if the packet originated at this node
-  			if (dataHdr.GetDaddrSrcAddress() == m_address)
-  			{
-  				if(!m_dlDataConfirmCallback.IsNull())
-  					m_dlDataConfirmCallback(params);
-  			}
+  		// Found Ack'd packet
+  		TxQueueElement *txQElement = indexIt->second;
+  		uint32_t queueInd = m_txQueue.Find(txQElement);
+  		NS_ASSERT(queueInd < m_txQueue.Size());
 
-  			m_dlRxTrace(m_address,p);
-  			NS_LOG_LOGIC(" ACK Confirmed: Ack with DMIC " << ackDmic << " received at node " << m_address);
+  		// Clear the arq backoff counter
+  		m_expArqBackoffCounter = 0;
 
-  			return;
+  		// Increment seq number
+  		m_neighbors.Get(txQElement->m_dstAddr)->m_txSeqNum = txQElement->m_seqNum + 1;
+
+  		DlDataConfirmParams params;
+  		params.m_dsduHandle = txQElement->m_dsduHandle;
+  		params.m_status = SUCCESS;
+
+  		bool localPacket = (txQElement->m_srcAddr == m_address);
+
+  		// Remove queue item
+  		RecordTxLatency(txQElement);
+  		m_txQueue.Remove(queueInd);
+  		DeleteTxElement(txQElement);
+
+  		// Only confirm to higher layer if the packet originated at this node
+  		if (localPacket)
+  		{
+  			if(!m_dlDataConfirmCallback.IsNull())
+  				m_dlDataConfirmCallback(params);
   		}
 
-  		// Increment iterator
-  		it++;
+  		m_dlRxTrace(m_address,p);
+  		NS_LOG_LOGIC(" ACK Confirmed: Ack with DMIC " << ackDmic << " received at node " << m_address);
+
+  		return;
   	}
 
   	// Ack'd packet could not be found in the tx queue
@@ -1006,20 +1467,15 @@ void Isa100Dl::ProcessPdDataIndication(uint32_t size, Ptr<Packet> p, uint32_t lq
 
   else
   {
+  	// Most receptions are overheard frames, so the checks are done on a peeked header and the packet
+  	// is only copied once it has to be modified for forwarding or delivered to the upper layer.
+  	// p itself is never modified and is what the traces see.
   	Isa100DlHeader rxDlHdr;
-  	Isa100DlTrailer trailer;
-  	Ptr<Packet> packetData = p->Copy();
-  	Ptr<Packet> origPacket = p->Copy();
-  	packetData->RemoveHeader(rxDlHdr);
-
-  	uTwoBytes_t finalDestBuffer;
-  	uTwoBytes_t shortDestBuffer;
-  	uTwoBytes_t shortSrcBuffer;
-  	rxDlHdr.GetDaddrDestAddress().CopyTo(finalDestBuffer.byte);
-  	rxDlHdr.GetShortDstAddr().CopyTo(shortDestBuffer.byte);
-  	rxDlHdr.GetShortSrcAddr().CopyTo(shortSrcBuffer.byte);
-  	uint8_t srcNodeInd = shortSrcBuffer.byte[1];
+  	p->PeekHeader(rxDlHdr);
+
+  	Mac16Address srcAddr = rxDlHdr.GetShortSrcAddr();
   	bool forwardPacketOn = false;
+  	Ptr<Packet> packetData;
 
 
   	// Else check for an address match
@@ -1046,22 +1502,27 @@ void Isa100Dl::ProcessPdDataIndication(uint32_t size, Ptr<Packet> p, uint32_t lq
   			m_dlTxTrace(m_address,ack);
 
   			// Add the ACK to the front of the queue and transmit it
-  			TxQueueElement *txQElement = new TxQueueElement;
+  			TxQueueElement *txQElement = m_txQueue.Allocate ();
   			txQElement->m_packet = ack;
   			txQElement->m_txAttemptsRem = 1;  // Attempt to send the ack just once
+  			txQElement->m_isAck = true;
+  			txQElement->m_ackReq = false;
+  			txQElement->m_dmic = ackHdr.GetDmic();
+  			txQElement->m_dstAddr = ackHdr.GetShortDstAddr();
+  			txQElement->m_srcAddr = m_address;
+  			txQElement->m_seqNum = 0;
+  			txQElement->m_priority = DL_PRIORITY_ALARM;
 
-  			m_txQueue.push_front(txQElement);
-
-  			ProcessTrxStateRequest((ZigbeePhyEnumeration)IEEE_802_15_4_PHY_TX_ON);
+  			if(EnqueueTxElement(txQElement, true))
+  				ProcessTrxStateRequest((ZigbeePhyEnumeration)IEEE_802_15_4_PHY_TX_ON);
 
   			return;
   		}
 
   		if(m_routingAlgorithm)
   		{
-
-  			// Need to remove the trailer to obtain just the packet data
-  			packetData->RemoveTrailer(trailer);
+  			Isa100DlTrailer trailer;
+  			p->PeekTrailer(trailer);
 
 
   			// GGM: Can we use this instead of programming the transmit power list into the node when we create its schedule?
@@ -1069,10 +1530,11 @@ void Isa100Dl::ProcessPdDataIndication(uint32_t size, Ptr<Packet> p, uint32_t lq
 
   			// Update the tx power for this neighbour
   			double chLossDb = trailer.GetDistrRoutingTxPower() - rxPowDbm;
-  			SetTxPowerDbm(chLossDb - 101, srcNodeInd);
+  			SetTxPowerDbm(chLossDb - 101, srcAddr);
 
   			// Process the rx packet
-  			m_routingAlgorithm->ProcessRxPacket(p,forwardPacketOn);
+  			packetData = p->Copy();
+  			m_routingAlgorithm->ProcessRxPacket(packetData,forwardPacketOn);
 
   		}
 
@@ -1080,25 +1542,32 @@ void Isa100Dl::ProcessPdDataIndication(uint32_t size, Ptr<Packet> p, uint32_t lq
   		if(forwardPacketOn)
   		{
   			// Create new DMIC for this packet
-  			uint64_t pVal= (uint64_t)PeekPointer(p);
+  			uint64_t pVal= (uint64_t)PeekPointer(packetData);
   			uint32_t dmic = (uint32_t)pVal;
 
   			// Modify header
   			Isa100DlHeader header;
-  			p->RemoveHeader(header);
+  			packetData->RemoveHeader(header);
   			header.SetDmic(dmic);
 
   			// Return the modified header to the packet.
-  			p->AddHeader(header);
+  			packetData->AddHeader(header);
 
-  			TxQueueElement *txQElement = new TxQueueElement;
+  			TxQueueElement *txQElement = m_txQueue.Allocate ();
   			txQElement->m_dsduHandle = 0;
-  			txQElement->m_packet = p;
+  			txQElement->m_packet = packetData;
   			txQElement->m_txAttemptsRem = m_maxFrameRetries + 1; // number of retries plus the initial tx attempt
+  			txQElement->m_isAck = false;
+  			txQElement->m_ackReq = (header.GetDhdrFrameControl().ackReq == 1);
+  			txQElement->m_dmic = dmic;
+  			txQElement->m_dstAddr = header.GetShortDstAddr();
+  			txQElement->m_srcAddr = header.GetDaddrSrcAddress();
 
-  			m_txQueue.push_back(txQElement);
+  			txQElement->m_seqNum = header.GetSeqNum();
+  			txQElement->m_priority = std::min<uint8_t>(header.GetPriority(), DL_NUM_PRIORITY_CLASSES - 1);
 
-  			m_dlForwardTrace(m_address,p);
+  			if(EnqueueTxElement(txQElement, false))
+  				m_dlForwardTrace(m_address,packetData);
 
   			return;
 
@@ -1107,10 +1576,10 @@ void Isa100Dl::ProcessPdDataIndication(uint32_t size, Ptr<Packet> p, uint32_t lq
   		// Accept any packet with a sequence number >= to what we're expecting.
 
   		// GGM: Disabled this check because we need to handle the 8 bit wrap around (and really redesign this whole DL..)
-  		else if (1 || rxDlHdr.GetSeqNum() >= m_nextRxPacketSeqNum[srcNodeInd])
+  		else if (1 || rxDlHdr.GetSeqNum() >= m_neighbors.Get(srcAddr)->m_nextRxSeqNum)
   		{
-  			m_nextRxPacketSeqNum[srcNodeInd]= rxDlHdr.GetSeqNum() + 1;
-  			m_dlRxTrace(m_address,origPacket);
+  			m_neighbors.Get(srcAddr)->m_nextRxSeqNum = rxDlHdr.GetSeqNum() + 1;
+  			m_dlRxTrace(m_address,p);
   			NS_LOG_LOGIC(" Packet received successfully at node address " << m_address << " (Time: " << Simulator::Now().GetSeconds() << ")");
 
   			DlDataIndicationParams params;
@@ -1118,6 +1587,15 @@ void Isa100Dl::ProcessPdDataIndication(uint32_t size, Ptr<Packet> p, uint32_t lq
   			params.m_destAddr = rxDlHdr.GetDaddrDestAddress();
   			params.m_dsduLength = size;
 
+  			// Strip the DL header (and the trailer, if the routing algorithm used it) from the payload.
+  			if(!packetData)
+  				packetData = p->Copy();
+  			else{
+  				Isa100DlTrailer trailer;
+  				packetData->RemoveTrailer(trailer);
+  			}
+  			packetData->RemoveHeader(rxDlHdr);
+
   			if(!m_dlDataIndicationCallback.IsNull())
   				m_dlDataIndicationCallback(params,packetData);
 
@@ -1126,13 +1604,15 @@ void Isa100Dl::ProcessPdDataIndication(uint32_t size, Ptr<Packet> p, uint32_t lq
   	}
 
   	// At this point, we either didn't have an address match or the sequence number was wrong.
-  	m_dlRxDropTrace(m_address,origPacket);
+  	m_dlRxDropTrace(m_address,p);
+
+  	Isa100DlNeighbor *srcNeighbor = m_neighbors.Find(srcAddr);
 
   	std::stringstream msg;
   	msg << " Packet Dropped:  Hop dest " << rxDlHdr.GetShortDstAddr() << " received at node "
-  			<< m_address << " from " << rxDlHdr.GetShortSrcAddr() << ", Seq num: " << (uint16_t)rxDlHdr.GetSeqNum() << " (expected: " << (uint16_t)m_nextRxPacketSeqNum[srcNodeInd] << ")";
+  			<< m_address << " from " << rxDlHdr.GetShortSrcAddr() << ", Seq num: " << (uint16_t)rxDlHdr.GetSeqNum() << " (expected: " << (srcNeighbor ? (uint16_t)srcNeighbor->m_nextRxSeqNum : 0) << ")";
 
-		m_infoDropTrace(m_address,origPacket, msg.str());
+		m_infoDropTrace(m_address,p, msg.str());
 
   	NS_LOG_LOGIC(msg.str());
 
@@ -1147,21 +1627,21 @@ void Isa100Dl::DlDataRequest (DlDataRequestParams params, Ptr<Packet> p)
   NS_LOG_FUNCTION (this << *p << m_address << Simulator::Now().GetSeconds());
 
   // Task log
-  std::stringstream ss;
-  ss << "A request has been made to send data to " << params.m_destAddr;
-  std::string msg = ss.str();
-  m_dlTaskTrace(m_address, msg);
+  uTwoBytes_t destAddr;
+  params.m_destAddr.CopyTo (destAddr.byte);
+  m_dlTaskTrace(m_address, DL_TASK_DATA_REQUEST, (destAddr.byte[0] << 8) | destAddr.byte[1]);
 
   NS_LOG_LOGIC(" Sending packet from " << params.m_srcAddr << " to " << params.m_destAddr);
 
   Isa100DlHeader dlHdr;
-  TxQueueElement *txQElement = new TxQueueElement;
+  TxQueueElement *txQElement = m_txQueue.Allocate ();
+
+  NS_ASSERT_MSG(params.m_priority < DL_NUM_PRIORITY_CLASSES, "DlDataRequest: Invalid priority class " << (int)params.m_priority);
 
   dlHdr.SetDaddrSrcAddress(params.m_srcAddr);
   dlHdr.SetDaddrDestAddress(params.m_destAddr);
+  dlHdr.SetPriority(params.m_priority);
 
-  uTwoBytes_t buffer;
-  params.m_destAddr.CopyTo(buffer.byte);
 
   	if( m_ackEnabled ){
 
@@ -1198,7 +1678,15 @@ void Isa100Dl::DlDataRequest (DlDataRequestParams params, Ptr<Packet> p)
   // Add packet to the queue
   txQElement->m_packet = p;
   txQElement->m_dsduHandle = params.m_dsduHandle;
-  m_txQueue.push_back(txQElement);
+  txQElement->m_isAck = false;
+  txQElement->m_ackReq = (dlHdr.GetDhdrFrameControl().ackReq == 1);
+  txQElement->m_dmic = dlHdr.GetDmic();
+  txQElement->m_dstAddr = dlHdr.GetShortDstAddr();
+  txQElement->m_srcAddr = dlHdr.GetDaddrSrcAddress();
+
+  txQElement->m_seqNum = dlHdr.GetSeqNum();
+  txQElement->m_priority = params.m_priority;
+  EnqueueTxElement(txQElement, false);
 
 }
 
@@ -1220,6 +1708,32 @@ double Isa100Dl::CalculateDropRatio (void) const
   return ((double)m_numFramesDrop / (double)m_numFramesSent);
 }
 
+uint32_t Isa100Dl::GetTxPacketCount (Isa100DlPriority priority) const
+{
+  NS_ASSERT(priority < DL_NUM_PRIORITY_CLASSES);
+  return m_priorityTxCount[priority];
+}
+
+Time Isa100Dl::GetMeanTxLatency (Isa100DlPriority priority) const
+{
+  NS_ASSERT(priority < DL_NUM_PRIORITY_CLASSES);
+  if (m_priorityTxCount[priority] == 0){
+    return Seconds(0.0);
+  }
+  return NanoSeconds(m_priorityLatencySum[priority].GetNanoSeconds() / m_priorityTxCount[priority]);
+}
+
+Time Isa100Dl::GetMaxTxLatency (Isa100DlPriority priority) const
+{
+  NS_ASSERT(priority < DL_NUM_PRIORITY_CLASSES);
+  return m_priorityLatencyMax[priority];
+}
+
+uint32_t Isa100Dl::GetNumReroutes (void) const
+{
+  return m_numReroutes;
+}
+
 Time Isa100Dl::GetTimeToNextSlot (void)
 {
   Time timeToSlot = Time::From(m_nextProcessLink.GetTs()) - Simulator::Now();
@@ -1230,16 +1744,70 @@ Time Isa100Dl::GetTimeToNextSlot (void)
 
 void Isa100Dl::FlushTxQueue(void)
 {
-  for (uint32_t i = 0; i < m_txQueue.size (); i++)
+  for (uint32_t i = 0; i < m_txQueue.Size (); i++)
   {
-    m_dlTxDropTrace(m_address,m_txQueue[i]->m_packet);
-    m_infoDropTrace(m_address,m_txQueue[i]->m_packet, "Packet was flushed out of the Dl Tx Queue by a higher layer.");
+    m_dlTxDropTrace(m_address,m_txQueue.Get(i)->m_packet,DL_TX_DROP_FLUSHED);
+    m_infoDropTrace(m_address,m_txQueue.Get(i)->m_packet, "Packet was flushed out of the Dl Tx Queue by a higher layer.");
     m_numFramesDrop++;
 
-    m_txQueue[i]->m_packet = 0;
-    delete m_txQueue[i];
+    DeleteTxElement(m_txQueue.Get(i));
   }
-  m_txQueue.clear ();
+  m_txQueue.Clear ();
+}
+
+void Isa100Dl::SetTxQueueCapacity (uint32_t capacity)
+{
+  m_txQueue.SetCapacity (capacity);
+}
+
+uint32_t Isa100Dl::GetTxQueueCapacity (void) const
+{
+  return m_txQueue.GetCapacity ();
+}
+
+void Isa100Dl::SetAlarmServiceWeight (uint32_t weight)
+{
+  m_alarmWeight = weight;
+  RestartWeightedService ();
+}
+
+uint32_t Isa100Dl::GetAlarmServiceWeight (void) const
+{
+  return m_alarmWeight;
+}
+
+void Isa100Dl::SetControlServiceWeight (uint32_t weight)
+{
+  m_controlWeight = weight;
+  RestartWeightedService ();
+}
+
+uint32_t Isa100Dl::GetControlServiceWeight (void) const
+{
+  return m_controlWeight;
+}
+
+void Isa100Dl::SetPeriodicServiceWeight (uint32_t weight)
+{
+  m_periodicWeight = weight;
+  RestartWeightedService ();
+}
+
+uint32_t Isa100Dl::GetPeriodicServiceWeight (void) const
+{
+  return m_periodicWeight;
+}
+
+void Isa100Dl::RestartWeightedService (void)
+{
+  m_wrrClass = DL_PRIORITY_ALARM;
+  m_wrrCredit = m_alarmWeight;
+}
+
+void Isa100Dl::ChargeWeightedService (uint8_t priority)
+{
+  if (m_txPriorityService == DL_TX_PRIORITY_WEIGHTED && priority == m_wrrClass && m_wrrCredit)
+    m_wrrCredit--;
 }
 
 
@@ -1334,7 +1902,7 @@ Ptr<Isa100RoutingAlgorithm> Isa100Dl::GetRoutingAlgorithm()
 	return m_routingAlgorithm;
 }
 
-void Isa100Dl::SetTxPowersDbm(double * txPowers, uint8_t numNodes)
+void Isa100Dl::SetTxPowersDbm(double * txPowers, uint32_t numNodes)
 {
   NS_LOG_FUNCTION (this << txPowers << numNodes);
 
@@ -1350,9 +1918,20 @@ void Isa100Dl::SetTxPowersDbm(double * txPowers, uint8_t numNodes)
   // PHY layer stores max tx power as a 6-bit signed int so the double needs to be converted and range checked
   for (uint32_t i = 0; i < numNodes; i++)
   {
-  	if(txPowers[i] > (double)m_maxTxPowerDbm)
-  		val = m_maxTxPowerDbm;
-  	else if (txPowers[i] < (double)m_minTxPowerDbm)
+  	// Node addresses match their index in the array.
+  	uint8_t addrBuffer[2];
+  	addrBuffer[0] = 0xff & (i >> 8);
+  	addrBuffer[1] = 0xff & i;
+
+  	Mac16Address addr;
+  	addr.CopyFrom(addrBuffer);
+
+  	// Nodes out of range would just be given the maximum power, which is also what's used for nodes
+  	// that aren't in the neighbour table.
+  	if(addr == m_address || txPowers[i] > (double)m_maxTxPowerDbm)
+  		continue;
+
+  	if (txPowers[i] < (double)m_minTxPowerDbm)
   		val = m_minTxPowerDbm;
   	else
   		val = (int8_t)ceil(txPowers[i]);
@@ -1365,21 +1944,16 @@ void Isa100Dl::SetTxPowersDbm(double * txPowers, uint8_t numNodes)
     else if (val > 31)
       val = 31;
 
-    m_txPowerDbm[i] = val;
+    m_neighbors.Get(addr)->m_txPowerDbm = val;
 
-    ss << "(" << i << "," << txPowers[i] << " > " << (int)val << ") ";
+    ss << "(" << addr << "," << txPowers[i] << " > " << (int)val << ") ";
   }
-  NS_LOG_DEBUG(ss.str());
+  NS_LOG_DEBUG(ss.str() << m_neighbors.Size() << " neighbours.");
 }
 
-int8_t* Isa100Dl::GetTxPowersDbm (void)
+void Isa100Dl::SetTxPowerDbm(double txPower, Mac16Address dest)
 {
-  return m_txPowerDbm;
-}
-
-void Isa100Dl::SetTxPowerDbm(double txPower, uint8_t destNodeI)
-{
-  NS_LOG_FUNCTION (this << txPower << destNodeI);
+  NS_LOG_FUNCTION (this << txPower << dest);
 
   int8_t val;
 
@@ -1400,12 +1974,26 @@ void Isa100Dl::SetTxPowerDbm(double txPower, uint8_t destNodeI)
   else if (val > 31)
     val = 31;
 
-  m_txPowerDbm[destNodeI] = val;
+  m_neighbors.Get(dest)->m_txPowerDbm = val;
 }
 
-int8_t Isa100Dl::GetTxPowerDbm (uint8_t destNodeI)
+int8_t Isa100Dl::GetTxPowerDbm (Mac16Address dest)
 {
-  return m_txPowerDbm[destNodeI];
+  Isa100DlNeighbor *neighbor = m_neighbors.Find(dest);
+
+  if (neighbor && neighbor->m_txPowerDbm != ISA100_DL_TX_POWER_UNSET)
+    return neighbor->m_txPowerDbm;
+
+  // No power has been set for this node, use the maximum.
+  int8_t val = m_maxTxPowerDbm;
+
+  if (val < -32)
+    val = -32;
+
+  else if (val > 31)
+    val = 31;
+
+  return val;
 }
 
 } // namespace ns3
@@ -25,10 +25,13 @@
 #define ISA100_DL_H
 
 #include <deque>
+#include <map>
 
 #include "ns3/zigbee-phy.h"
 #include "ns3/mac16-address.h"
 #include "ns3/isa100-processor.h"
+#include "ns3/isa100-dl-tx-queue.h"
+#include "ns3/isa100-dl-neighbor-table.h"
 
 
 namespace ns3 {
@@ -76,6 +79,80 @@ typedef enum
   IEEE_802_15_4_INVALID_PARAMETER      = 11
 } LrWpanMcpsDataConfirmStatus;
 
+/** Events reported by the DlTaskTrace source.
+ * - Each event is traced with a value whose meaning is given in Isa100DlTaskEventNames.
+ * - Sinks format the event themselves, so an unconnected trace source costs nothing.
+ */
+typedef enum
+{
+  DL_TASK_STARTED = 0,
+  DL_TASK_ENDED,
+  DL_TASK_SCHEDULE_SET,
+  DL_TASK_CHANNEL_HOP,
+  DL_TASK_TRX_STATE_REQUEST,
+  DL_TASK_CCA_REQUEST,
+  DL_TASK_CCA_IDLE,
+  DL_TASK_CCA_BUSY,
+  DL_TASK_TX_ON_CONFIRMED,
+  DL_TASK_WOKE_UP,
+  DL_TASK_PD_DATA_CONFIRM,
+  DL_TASK_PD_DATA_INDICATION,
+  DL_TASK_RX_PROCESSED,
+  DL_TASK_DATA_REQUEST
+} Isa100DlTaskEvent;
+
+// Matching descriptions of Isa100DlTaskEvent used for readable printing (make sure cpp definition matches above enum)
+extern const char * Isa100DlTaskEventNames[];
+
+/** Reasons reported by the DlTxDrop trace source.
+ */
+typedef enum
+{
+  DL_TX_DROP_RETRIES_EXHAUSTED = 0,
+  DL_TX_DROP_PHY_BUSY,
+  DL_TX_DROP_FLUSHED,
+  DL_TX_DROP_QUEUE_OVERFLOW
+} Isa100DlTxDropReason;
+
+// Matching descriptions of Isa100DlTxDropReason used for readable printing (make sure cpp definition matches above enum)
+extern const char * Isa100DlTxDropReasonNames[];
+
+/** Packet dropped when the transmit queue is full.
+ * - The front of the queue may be in the middle of a transmission so it is never dropped.
+ * - The policy only applies to data packets.  An ACK for a received frame displaces the newest queued
+ *   data packet instead, since dropping the ACK would only make the sender retransmit.
+ */
+typedef enum
+{
+  DL_TX_QUEUE_TAIL_DROP = 0,  ///< Drop the new packet.
+  DL_TX_QUEUE_HEAD_DROP,  ///< Drop the oldest queued packet.
+  DL_TX_QUEUE_DROP_OLDEST_DATA  ///< Drop the oldest queued packet that isn't an ACK.
+} Isa100DlTxQueuePolicy;
+
+/** Priority classes of DL data packets.
+ * - Carried in the DROUT priority field so relays queue forwarded packets in the same class.
+ * - A higher value is a more important class, so a zeroed priority field is periodic traffic.
+ */
+typedef enum
+{
+  DL_PRIORITY_PERIODIC = 0,  ///< Periodic sensor reports.
+  DL_PRIORITY_CONTROL,  ///< Control traffic.
+  DL_PRIORITY_ALARM,  ///< Process alarms.
+  DL_NUM_PRIORITY_CLASSES
+} Isa100DlPriority;
+
+// Matching descriptions of Isa100DlPriority used for readable printing (make sure cpp definition matches above enum)
+extern const char * Isa100DlPriorityNames[];
+
+/** How the DL chooses the class of the next packet sent from the transmit queue.
+ * - Packets are sent in FIFO order within a class and ACKs are always sent first.
+ */
+typedef enum
+{
+  DL_TX_PRIORITY_STRICT = 0,  ///< Always send the most important class with a queued packet.
+  DL_TX_PRIORITY_WEIGHTED  ///< Weighted round robin between classes using the class service weights.
+} Isa100DlTxPriorityService;
+
 
 
 
@@ -94,6 +171,7 @@ struct DlDataRequestParams
 	Mac16Address m_destAddr;
 	uint8_t m_dsduLength; ///< DPDU payload length (in octets)
 	uint8_t m_dsduHandle; ///< Identifier for this data request used by confirm callback.
+	uint8_t m_priority; ///< Priority class (Isa100DlPriority).
 };
 
 /** Used by DL to indicate status of a transmission request.
@@ -195,6 +273,19 @@ typedef enum{
 
 class Isa100Dl;
 
+/** One active slot of a compiled superframe schedule.
+ * - Everything ProcessLink needs for the slot is precomputed so dispatching a slot is a single table read.
+ */
+struct Isa100DlSlotAction
+{
+	uint32_t m_slot;      ///< Slot offset within the superframe (within the merged timeline for the DL table).
+	uint32_t m_slotJump;  ///< Number of slots until the next active slot.
+	uint8_t m_linkType;   ///< Link activity (DlLinkType).
+	uint8_t m_channel;    ///< Channel used in the slot.
+	uint8_t m_superframe; ///< Index of the superframe that owns the slot (0 is the SuperFrameSchedule attribute).
+	bool m_frameEnd;      ///< Last active slot before the superframe wraps.
+};
+
 /** Class that stores the ISA-100 Data Link superframe schedule.
  * - Includes both channel hopping and time slot schedules.
  * - Supports multi-superframes
@@ -243,6 +334,40 @@ public:
 	 */
 	std::vector<uint16_t> *GetFrameBounds(void);
 
+	/** Compile the link schedule and hopping pattern into a table of slot actions.
+	 * - The channel advances once per active slot so the table covers the least common multiple of the
+	 *   number of links and the hopping pattern length before it repeats.
+	 *
+	 * @param sfPeriod Number of timeslots in the superframe.
+	 */
+	void Compile(uint16_t sfPeriod);
+
+	/** Get the compiled slot actions.
+	 * - Empty until Compile() is called.
+	 */
+	const std::vector<Isa100DlSlotAction> &GetSlotActions(void) const;
+
+	/** Set the superframe period.
+	 *
+	 * @param period Number of timeslots in the superframe, 0 to use the DL SuperFramePeriod attribute.
+	 */
+	void SetPeriod(uint16_t period);
+
+	/** Get the superframe period (0 if the DL SuperFramePeriod attribute is used).
+	 */
+	uint16_t GetPeriod(void) const;
+
+	/** Set the superframe priority.
+	 * - When superframes running on the same DL use the same slot, the one with the highest priority gets the slot.
+	 *
+	 * @param priority Superframe priority.
+	 */
+	void SetPriority(uint8_t priority);
+
+	/** Get the superframe priority.
+	 */
+	uint8_t GetPriority(void) const;
+
 
 private:
 	std::vector<uint8_t> m_dlHoppingPattern;         ///< Channel hopping pattern (dlmo.Ch Table 160).
@@ -252,6 +377,9 @@ private:
 	std::vector<uint16_t> m_multiFrameBounds;        ///< Indexes in the above vectors which represent a new Frame
   std::vector<uint16_t> m_numPktsInSlot;           ///< The number of packets which are being sent during each slot
 	uint16_t m_currMultiFrameI;                      ///< Index of the current frame in a multiframe superframe
+	std::vector<Isa100DlSlotAction> m_slotActions;   ///< Compiled schedule, one entry per active slot.
+	uint16_t m_sfPeriod;                             ///< Superframe period (timeslots), 0 to use the DL period.
+	uint8_t m_priority;                              ///< Priority used to resolve slot conflicts between superframes.
 };
 
 
@@ -265,6 +393,49 @@ class Isa100Dl : public Object
 public:
   static TypeId GetTypeId (void);
 
+  /** Signature of the DlTaskTrace source.
+   *
+   * @param addr Address of the node.
+   * @param event The event that occurred.
+   * @param value Event dependent value (see Isa100DlTaskEventNames).
+   */
+  typedef void (* TaskEventTracedCallback)(Mac16Address addr, Isa100DlTaskEvent event, double value);
+
+  /** TracedCallback signature for transmit drops.
+   *
+   * @param addr Address of the node.
+   * @param p Dropped packet.
+   * @param reason Reason for the drop.
+   */
+  typedef void (* TxDropTracedCallback)(Mac16Address addr, Ptr<const Packet> p, Isa100DlTxDropReason reason);
+
+  /** TracedCallback signature for the queueing latency of sent packets.
+   *
+   * @param addr Address of the node.
+   * @param priority Priority class of the packet.
+   * @param latency Time from entering the tx queue to a successful transmission.
+   */
+  typedef void (* TxLatencyTracedCallback)(Mac16Address addr, Isa100DlPriority priority, Time latency);
+
+  /** TracedCallback signature for data packets moved to an alternate next hop.
+   *
+   * @param addr Address of the node.
+   * @param p Rerouted packet.
+   * @param failedHop Next hop the previous transmission attempt went to.
+   * @param nextHop Next hop of the following attempts.
+   */
+  typedef void (* TxRerouteTracedCallback)(Mac16Address addr, Ptr<const Packet> p, Mac16Address failedHop, Mac16Address nextHop);
+
+  /** TracedCallback signature for the outcome of each data packet sent with ACKs.
+   *
+   * @param addr Address of the node.
+   * @param nextHop Next hop of the last transmission attempt.
+   * @param success True if the packet was acknowledged, false if the transmit attempts ran out.
+   * @param attempts Number of transmission attempts used.
+   * @param latency Time from entering the tx queue to the outcome.
+   */
+  typedef void (* TxOutcomeTracedCallback)(Mac16Address addr, Mac16Address nextHop, bool success, uint8_t attempts, Time latency);
+
   Isa100Dl ();
 
   virtual ~Isa100Dl ();
@@ -280,6 +451,38 @@ public:
    */
   void SetDlSfSchedule(Ptr<Isa100DlSfSchedule> schedule);
 
+  /** Add a superframe that runs concurrently with the one set by SetDlSfSchedule().
+   * - Must be called before Start().
+   * - All superframes are merged into a single timeline when the DL starts.  A superframe uses its own
+   *   period (Isa100DlSfSchedule::SetPeriod) and hopping pattern.  If two superframes have a link in the
+   *   same slot, the one with the higher priority keeps it and the other link is skipped.
+   * - The frame complete callback (and so the per superframe energy trace) still fires at the period
+   *   boundaries of superframe 0, not at the end of the merged timeline.  Use GetTimelinePeriod() for the
+   *   time the combined schedule takes to repeat.
+   *
+   * @param schedule Object storing schedule information.
+   */
+  void AddDlSfSchedule(Ptr<Isa100DlSfSchedule> schedule);
+
+  /** Get the number of superframes running on the DL.
+   *
+   */
+  uint32_t GetNumDlSfSchedules(void) const;
+
+  /** Get one of the superframes running on the DL.
+   *
+   * @param index 0 for the superframe set by SetDlSfSchedule(), 1 onwards for those added by AddDlSfSchedule().
+   * @return Pointer to the superframe schedule.
+   */
+  Ptr<Isa100DlSfSchedule> GetDlSfSchedule(uint32_t index) const;
+
+  /** Get the time the merged timeline of all superframes takes to repeat.
+   * - Compiles the superframes if the DL hasn't started yet.
+   *
+   * @return Duration of the merged timeline.
+   */
+  Time GetTimelinePeriod(void);
+
   /** Set the routing algorithm object.
    *
    * \param algorithm Pointer to the routing algorithm object.
@@ -292,24 +495,25 @@ public:
    */
   Ptr<Isa100RoutingAlgorithm> GetRoutingAlgorithm();
 
-  /** Set/Get the tx power level (dBm) for this node to reach all others.
+  /** Set the tx power level (dBm) for this node to reach all others.
    * Converts double values to 6-bit ints by rounding up (ceiling).
+   * - Only nodes that can be reached with the maximum tx power are added to the neighbour table.
    *
    * @param txPowers An array of tx power levels in which the index corresponds to the
    *                 other nodes' addresses
-   * @param size The number of nodes in the network
+   * @param numNodes The number of nodes in the network
    */
-  void SetTxPowersDbm (double * txPowers, uint8_t numNodes);
-  int8_t* GetTxPowersDbm (void);
+  void SetTxPowersDbm (double * txPowers, uint32_t numNodes);
 
   /** Set/Get the tx power level (dBm) for this node to reach another node
    * Converts double values to 6-bit ints by rounding up (ceiling).
+   * - Get returns the maximum tx power if no power has been set for the node.
    *
-   * @param txPower The tx power level required to reach the indexed node
-   * @param destNodeI The index of the node to reach
+   * @param txPower The tx power level required to reach the node
+   * @param dest The address of the node to reach
    */
-  void SetTxPowerDbm (double txPower, uint8_t destNodeI);
-  int8_t GetTxPowerDbm (uint8_t destNodeI);
+  void SetTxPowerDbm (double txPower, Mac16Address dest);
+  int8_t GetTxPowerDbm (Mac16Address dest);
 
 
   /** Function used to process the PSDU received from the PHY.
@@ -488,6 +692,30 @@ public:
    */
   double CalculateDropRatio (void) const;
 
+  /** Get the number of data packets of a priority class successfully sent from the tx queue.
+   *
+   * @param priority Priority class.
+   */
+  uint32_t GetTxPacketCount (Isa100DlPriority priority) const;
+
+  /** Get the average time data packets of a priority class spent in the tx queue before being successfully sent.
+   * - Measured from entering the queue to the confirm (no ACKs) or ACK (ACKs enabled) of the packet.
+   *
+   * @param priority Priority class.
+   */
+  Time GetMeanTxLatency (Isa100DlPriority priority) const;
+
+  /** Get the longest time a data packet of a priority class spent in the tx queue before being successfully sent.
+   *
+   * @param priority Priority class.
+   */
+  Time GetMaxTxLatency (Isa100DlPriority priority) const;
+
+  /** Get the number of times a data packet was moved to an alternate next hop after a failed transmission.
+   *
+   */
+  uint32_t GetNumReroutes (void) const;
+
   /** Get the time duration until the start of the next timeslot
    *
    * @return the time duration
@@ -498,6 +726,52 @@ public:
    */
   void FlushTxQueue (void);
 
+  /** Set the maximum number of packets in the tx queue.
+   * - The tx queue must be empty.
+   *
+   * @param capacity Number of packets.
+   */
+  void SetTxQueueCapacity (uint32_t capacity);
+
+  /** Get the maximum number of packets in the tx queue.
+   *
+   */
+  uint32_t GetTxQueueCapacity (void) const;
+
+  /** Set the number of alarm packets sent per round of weighted priority service.
+   * - Changing any of the weights restarts the round at the alarm class.
+   *
+   * @param weight Number of packets.
+   */
+  void SetAlarmServiceWeight (uint32_t weight);
+
+  /** Get the number of alarm packets sent per round of weighted priority service.
+   *
+   */
+  uint32_t GetAlarmServiceWeight (void) const;
+
+  /** Set the number of control packets sent per round of weighted priority service.
+   *
+   * @param weight Number of packets.
+   */
+  void SetControlServiceWeight (uint32_t weight);
+
+  /** Get the number of control packets sent per round of weighted priority service.
+   *
+   */
+  uint32_t GetControlServiceWeight (void) const;
+
+  /** Set the number of periodic packets sent per round of weighted priority service.
+   *
+   * @param weight Number of packets.
+   */
+  void SetPeriodicServiceWeight (uint32_t weight);
+
+  /** Get the number of periodic packets sent per round of weighted priority service.
+   *
+   */
+  uint32_t GetPeriodicServiceWeight (void) const;
+
   /**}@*/
 
 
@@ -509,12 +783,23 @@ private:
   virtual void DoDispose (void);
 
   /** Implements slotted channel hoping.
-   * - A simple algorithm that changes channel each superframe timeslot.
+   * - A simple algorithm that changes channel each active superframe timeslot.
+   * - The PHY is only told about the change if the channel is different from the current one.
    * - This function could be later replaced with a base class to allow
    *   different hopping algorithms (ie. slow or hybrid hopping) to be
    *   implemented via inheritance.
+   *
+   * \param channelNum Channel for the slot.
+   */
+  void ChannelHop(uint8_t channelNum);
+
+  /** Merge all superframes into the timeline of slot actions used by ProcessLink.
+   * - The timeline covers the least common multiple of the superframe cycles (period times the number of
+   *   periods the compiled superframe takes to repeat).
+   * - Frame ends are marked at the period boundaries of superframe 0 so the frame complete callback keeps
+   *   its single superframe meaning.
    */
-  void ChannelHop();
+  void CompileSfSchedules();
 
   /** Processes link activity.
    * - Recursively scheduled to execute on the active slots indicated
@@ -540,6 +825,79 @@ private:
    */
    bool IsAckPacket(Ptr<const Packet> p);
 
+  typedef Isa100DlTxQueueElement TxQueueElement;
+
+  /** Add a packet to the transmit queue, applying the overflow policy if the queue is full.
+   * - A new ACK pushes out the newest queued data packet instead, it is only dropped if there is no data
+   *   packet behind the front of the queue.
+   *
+   * \param element Queue element taken from m_txQueue.Allocate().
+   * \param front Add the packet to the front of the queue instead of the back.
+   * \return False if the new packet was dropped.
+   */
+  bool EnqueueTxElement(TxQueueElement *element, bool front);
+
+  /** Drop a packet that has been removed from the transmit queue.
+   * - Traces the drop, confirms the failure to the upper layer if the packet originated at this node
+   *   and frees the element.
+   *
+   * \param element Queue element.
+   * \param reason Reason for the drop.
+   * \param msg Description for the info drop trace.
+   */
+  void DropTxElement(TxQueueElement *element, Isa100DlTxDropReason reason, std::string msg);
+
+  /** Add a data packet to the DMIC index of the transmit queue.
+   *
+   * \param element Queue element.
+   */
+  void IndexTxElement(TxQueueElement *element);
+
+  /** Remove a transmit queue element from the DMIC index and return it to the pool.
+   * - The caller removes the element from m_txQueue.
+   *
+   * \param element Queue element.
+   */
+  void DeleteTxElement(TxQueueElement *element);
+
+  /** Move the next data packet to be served to the front of the transmit queue.
+   * - Nothing is moved while the front packet is an ACK or has already been transmitted.
+   * - Weighted service credit isn't used here, see ChargeWeightedService().
+   */
+  void SelectTxElement(void);
+
+  /** Start a new round of weighted priority service at the alarm class with its full credit.
+   *
+   */
+  void RestartWeightedService(void);
+
+  /** Use one packet of weighted service credit when a data packet is first transmitted.
+   * - Slots lost to a busy CCA or backoff don't count against the class.
+   *
+   * \param priority Priority class of the transmitted packet.
+   */
+  void ChargeWeightedService(uint8_t priority);
+
+  /** Update the latency counters of the element's priority class for a successfully sent data packet.
+   *
+   * \param element Queue element.
+   */
+  void RecordTxLatency(TxQueueElement *element);
+
+  /** Fire the outcome trace for a data packet leaving the tx queue.
+   *
+   * \param element Queue element.
+   * \param success True if the packet was acknowledged.
+   */
+  void RecordTxOutcome(TxQueueElement *element, bool success);
+
+  /** Ask the routing algorithm for an alternate next hop before a data packet is retransmitted.
+   * - The packet keeps its current next hop if every alternate has been attempted.
+   *
+   * \param element Queue element at the front of the tx queue.
+   */
+  void RerouteTxElement(TxQueueElement *element);
+
 
   // ------- Trace Functions --------
   /** Trace source for all packets entering transmitter.
@@ -549,7 +907,7 @@ private:
   /** Trace source for packets dropped in the transmitter.
    *  - Usually packets in the queue unable to be sent due to channel congestion.
    */
-  TracedCallback< Mac16Address, Ptr<const Packet> > m_dlTxDropTrace;
+  TracedCallback< Mac16Address, Ptr<const Packet>, Isa100DlTxDropReason > m_dlTxDropTrace;
 
   /** Trace source for all packets successfully received by the DL.
    */
@@ -574,27 +932,44 @@ private:
   TracedCallback<Mac16Address, DlLinkType, uint16_t, uint16_t, uint16_t> m_processLinkTrace;
 
   /** Trace source for info about dl tasks.
-   *  - Address, task description
+   *  - Address, task event, event dependent value (see Isa100DlTaskEventNames)
    */
-  TracedCallback<Mac16Address, std::string> m_dlTaskTrace;
+  TracedCallback<Mac16Address, Isa100DlTaskEvent, double> m_dlTaskTrace;
 
   /** Trace source for indicating a retransmission
    *  - Address
    */
   TracedCallback<Mac16Address> m_retrxTrace;
 
-  // -------- Member Variables ----------
+  /** Trace source for the queueing latency of successfully sent data packets.
+   *  - Address, priority class, latency
+   */
+  TracedCallback<Mac16Address, Isa100DlPriority, Time> m_txLatencyTrace;
+
+  /** Trace source for data packets moved to an alternate next hop.
+   *  - Address, packet, failed next hop, new next hop
+   */
+  TracedCallback<Mac16Address, Ptr<const Packet>, Mac16Address, Mac16Address> m_txRerouteTrace;
 
-  /** Structure for storing a queued packet and associated information.
-   * - Fields can be added in the future to indicate different priorities in the queue.
+  /** Trace source for the outcome of each data packet sent with ACKs.
+   *  - Address, next hop, success, transmission attempts, latency
    */
-  struct TxQueueElement
-  {
-    uint8_t m_dsduHandle;
-    uint8_t m_txAttemptsRem;
-    Ptr<Packet> m_packet;
-  };
-  std::deque<TxQueueElement*> m_txQueue;  ///< Transmit packet queue.
+  TracedCallback<Mac16Address, Mac16Address, bool, uint8_t, Time> m_txOutcomeTrace;
+
+  // -------- Member Variables ----------
+
+  Isa100DlTxQueue m_txQueue;  ///< Transmit packet queue.
+  Isa100DlTxQueuePolicy m_txQueuePolicy;  ///< Packet dropped when the transmit queue is full.
+  std::multimap<uint32_t, TxQueueElement*> m_txDmicIndex;  ///< Data packets in m_txQueue, indexed by DMIC for matching ACKs.
+  Isa100DlTxPriorityService m_txPriorityService;  ///< How the next priority class to send is chosen.
+  uint32_t m_periodicWeight;  ///< Weighted service: periodic packets sent per round.
+  uint32_t m_controlWeight;  ///< Weighted service: control packets sent per round.
+  uint32_t m_alarmWeight;  ///< Weighted service: alarm packets sent per round.
+  uint8_t m_wrrClass;  ///< Weighted service: class currently being served.
+  uint32_t m_wrrCredit;  ///< Weighted service: packets the current class can still transmit this round.
+  uint32_t m_priorityTxCount[DL_NUM_PRIORITY_CLASSES];  ///< Data packets successfully sent per class.
+  Time m_priorityLatencySum[DL_NUM_PRIORITY_CLASSES];  ///< Total queueing latency per class.
+  Time m_priorityLatencyMax[DL_NUM_PRIORITY_CLASSES];  ///< Maximum queueing latency per class.
 
   DlDataConfirmCallback m_dlDataConfirmCallback;  ///< Pointer to data confirm callback function.
   DlDataIndicationCallback m_dlDataIndicationCallback;  ///< Pointer to data indication callback function.
@@ -612,26 +987,29 @@ private:
   uint16_t m_sfPeriod;  ///< Superframe period (number of timeslots).
   Time m_sfSlotDuration; ///< Duration of timeslot within a superframe (ms)
 
-  uint32_t m_dlHopIndex;  ///< Index of current channel in the hopping pattern.
-  uint32_t m_dlLinkIndex; ///< Index of current link activity in the superframe.
+  uint8_t m_currentChannel;  ///< Channel the PHY is currently set to.
+  uint32_t m_dlLinkIndex; ///< Index of the next slot action in the compiled superframe schedule.
   uint16_t m_expBackoffCounter; ///< Backoff counter used for shared timeslots.
   uint8_t m_backoffExponent; ///< Used to determine max number of backoff slots.
   uint16_t m_expArqBackoffCounter; ///< Backoff counter used for arq retransmissions.
   uint8_t m_arqBackoffExponent; ///< Used to determine max number of arq backoff slots.
-  uint8_t m_packetTxSeqNum[256]; ///< Transmitted packet sequence number.
-  uint8_t m_nextRxPacketSeqNum[256];  ///< Sequence number of the next packet expected.
+  Isa100DlNeighborTable m_neighbors; ///< Sequence numbers and tx power for each neighbour.
   uint8_t m_maxFrameRetries; ///< The max number of retries allowed after a transmission failure. (Range: 0 to 7)
   int8_t m_maxTxPowerDbm; ///< The maximum transmit power at which this node can transmit at (in dBm)
   int8_t m_minTxPowerDbm; ///< The minimum transmit power at which this node can transmit at (in dBm)
 
-  int8_t m_txPowerDbm[256];   ///< A list of power required to transmit to each node (dBm)
   uint8_t m_usePowerCtrl;     ///< Is power control being used
 
   Ptr<Isa100DlSfSchedule> m_sfSchedule;  ///< Pointer to the superframe schedule.
+  std::vector< Ptr<Isa100DlSfSchedule> > m_addedSfSchedules;  ///< Superframes running concurrently with m_sfSchedule.
+  std::vector<Isa100DlSlotAction> m_slotActions;  ///< Merged timeline of all superframes, one entry per active slot.
+  uint16_t m_frameSlots;  ///< Period of superframe 0 in the merged timeline (timeslots).
+  uint32_t m_timelineSlots;  ///< Length of the merged timeline before it repeats (timeslots).
   uint16_t m_tdmaPktsLeft;               ///< For a tdma schedule the amount of packets left to send in the current slot
 
   Ptr<Isa100RoutingAlgorithm> m_routingAlgorithm; ///< Pointer to routing algorithm object.
   std::vector<Mac16Address> m_attemptedLinks; ///< A list of attempted links for the current tx packet
+  TxQueueElement *m_attemptedLinksElement; ///< Queue element m_attemptedLinks belongs to.
 
   EventId m_nextProcessLink;   ///< Next scheduled process link event
   Time m_nextProcessLinkDelay; ///< Remaining delay until when process link is suppose to run again
@@ -645,6 +1023,7 @@ private:
   uint32_t m_numFramesSent;   ///< Total number of transmitted frames
   uint32_t m_numFramesDrop;   ///< Total number of dropped frames (rx and tx)
   uint32_t m_numRetrx;        ///< Total number of retransmissions
+  uint32_t m_numReroutes;     ///< Total number of retransmissions moved to an alternate next hop
 
   Ptr<Isa100Processor> m_processor; ///< Pointer to the node processor.
   bool m_dlSleepEnabled; ///< Indicates whether DL is capable of sleeping.
@@ -24,6 +24,12 @@
 #include "ns3/log.h"
 
 #include "ns3/isa100-error-model.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+
+#include <map>
+#include <algorithm>
 
 
 NS_LOG_COMPONENT_DEFINE ("Isa100ErrorModel");
@@ -32,22 +38,58 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (Isa100ErrorModel);
 
+// SINR range covered by the lookup table.  Above the range the BER is below 1e-20 so
+// the chunk always succeeds.  Below it the analytic expression is used.
+static const double LOOKUP_MIN_DB = -10.0;
+static const double LOOKUP_MAX_DB = 20.0;
+
 TypeId
 Isa100ErrorModel::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::Isa100ErrorModel")
     .SetParent<Object> ()
     .AddConstructor<Isa100ErrorModel> ()
+    .AddAttribute ("UseLookupTable",
+                   "Read the chunk success rate from a precomputed table rather than calculating it.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Isa100ErrorModel::m_useTable),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxLookupError",
+                   "Largest absolute error of the chunk success rate allowed for the lookup table.",
+                   DoubleValue (1e-4),
+                   MakeDoubleAccessor (&Isa100ErrorModel::SetMaxLookupError,
+                                       &Isa100ErrorModel::GetMaxLookupError),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MaxLookupBits",
+                   "Longest chunk (bits) the lookup table accuracy bound must hold for.  Default is a max length PSDU.",
+                   UintegerValue (127*8),
+                   MakeUintegerAccessor (&Isa100ErrorModel::SetMaxLookupBits,
+                                         &Isa100ErrorModel::GetMaxLookupBits),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
 
 Isa100ErrorModel::Isa100ErrorModel ()
 {
+  m_useTable = false;
+  m_maxError = 1e-4;
+  m_maxBits = 127*8;
+  m_table = 0;
 }
 
 double
-Isa100ErrorModel::GetChunkSuccessRate (double snr, uint32_t nbits) const
+Isa100ErrorModel::GetLogBitSuccess (double snr) const
+{
+	// Q(x) = 0.5erfc(x/sqrt(2));
+
+  double ber = 0.5*erfc(sqrt(snr/2));
+
+  return log1p(-ber);
+}
+
+double
+Isa100ErrorModel::GetAnalyticChunkSuccessRate (double snr, uint32_t nbits) const
 {
 	// Q(x) = 0.5erfc(x/sqrt(2));
 
@@ -56,5 +98,130 @@ Isa100ErrorModel::GetChunkSuccessRate (double snr, uint32_t nbits) const
   return pow(1.0-ber,nbits);
 }
 
+double
+Isa100ErrorModel::GetChunkSuccessRate (double snr, uint32_t nbits) const
+{
+  if (!m_useTable)
+    return GetAnalyticChunkSuccessRate (snr, nbits);
+
+  const Isa100ErrorModelTable *table = GetLookupTable ();
+
+  double snrDb = 10.0*log10(snr);
+  if (snrDb >= table->m_maxDb)
+    return 1.0;
+  if (!(snrDb >= table->m_minDb))
+    return GetAnalyticChunkSuccessRate (snr, nbits);
+
+  // Linear interpolation between the two neighbouring entries.
+  double pos = (snrDb - table->m_minDb) / table->m_stepDb;
+  uint32_t i = (uint32_t)pos;
+  if (i >= table->m_logSuccess.size () - 1)
+    i = table->m_logSuccess.size () - 2;
+  double frac = pos - i;
+  double logSuccess = table->m_logSuccess[i] + frac * (table->m_logSuccess[i+1] - table->m_logSuccess[i]);
+
+  return exp(nbits * logSuccess);
+}
+
+void
+Isa100ErrorModel::SetMaxLookupError (double maxError)
+{
+  m_maxError = maxError;
+  m_table = 0;
+}
+
+double
+Isa100ErrorModel::GetMaxLookupError (void) const
+{
+  return m_maxError;
+}
+
+void
+Isa100ErrorModel::SetMaxLookupBits (uint32_t maxBits)
+{
+  m_maxBits = maxBits;
+  m_table = 0;
+}
+
+uint32_t
+Isa100ErrorModel::GetMaxLookupBits (void) const
+{
+  return m_maxBits;
+}
+
+const Isa100ErrorModelTable*
+Isa100ErrorModel::GetLookupTable (void) const
+{
+  if (m_table)
+    return m_table;
+
+  // Tables only depend on the accuracy bound, so share them between all error models.
+  static std::map<std::pair<double, uint32_t>, Isa100ErrorModelTable> sharedTables;
+
+  std::pair<double, uint32_t> key (m_maxError, m_maxBits);
+  std::map<std::pair<double, uint32_t>, Isa100ErrorModelTable>::iterator it = sharedTables.find (key);
+  if (it == sharedTables.end ())
+    {
+      it = sharedTables.insert (std::make_pair (key, Isa100ErrorModelTable ())).first;
+      BuildLookupTable (m_maxError, m_maxBits, it->second);
+    }
+
+  m_table = &it->second;
+  return m_table;
+}
+
+void
+Isa100ErrorModel::BuildLookupTable (double maxError, uint32_t maxBits, Isa100ErrorModelTable &table) const
+{
+  NS_LOG_FUNCTION (this << maxError << maxBits);
+
+  // Chunk lengths the bound is checked at.  The interpolation error in the log domain
+  // scales with the chunk length, so the longest chunk dominates.
+  std::vector<uint32_t> checkBits;
+  for (uint32_t n = maxBits; n >= 1; n /= 2)
+    checkBits.push_back (n);
+
+  table.m_minDb = LOOKUP_MIN_DB;
+  table.m_maxDb = LOOKUP_MAX_DB;
+  table.m_stepDb = 0.5;
+
+  while (true)
+    {
+      uint32_t numEntries = (uint32_t)ceil ((table.m_maxDb - table.m_minDb) / table.m_stepDb) + 1;
+      table.m_logSuccess.resize (numEntries);
+      for (uint32_t i = 0; i < numEntries; i++)
+        {
+          double snr = pow (10.0, (table.m_minDb + i * table.m_stepDb) / 10.0);
+          table.m_logSuccess[i] = GetLogBitSuccess (snr);
+        }
+
+      // The interpolation error is largest half way between the entries.
+      double worstError = 0.0;
+      for (uint32_t i = 0; i + 1 < numEntries; i++)
+        {
+          double snr = pow (10.0, (table.m_minDb + (i + 0.5) * table.m_stepDb) / 10.0);
+          double logSuccess = 0.5 * (table.m_logSuccess[i] + table.m_logSuccess[i+1]);
+          for (uint32_t j = 0; j < checkBits.size (); j++)
+            {
+              double error = fabs (exp (checkBits[j] * logSuccess) - GetAnalyticChunkSuccessRate (snr, checkBits[j]));
+              worstError = std::max (worstError, error);
+            }
+        }
+
+      NS_LOG_LOGIC (" Lookup table with " << numEntries << " entries (" << table.m_stepDb << " dB) has max error " << worstError);
+
+      if (worstError <= maxError || table.m_stepDb < 1e-4)
+        break;
+
+      table.m_stepDb /= 2.0;
+    }
+
+  // The loop rounds the number of entries up so the last entry may be beyond the nominal range.
+  table.m_maxDb = table.m_minDb + (table.m_logSuccess.size () - 1) * table.m_stepDb;
+
+  NS_LOG_INFO ("Isa100ErrorModel lookup table: " << table.m_logSuccess.size () << " entries, "
+               << table.m_stepDb << " dB spacing, max error " << maxError);
+}
+
 
 } // namespace ns3
@@ -22,12 +22,34 @@
 
 #include "ns3/net-device.h"
 
+#include <vector>
+
 namespace ns3 {
 
+/** Lookup table of the per bit log success probability.
+ * - Entry i holds log(1 - BER) at an SINR of m_minDb + i * m_stepDb dB.
+ * - Since the chunk success rate is exp(nbits * log(1 - BER)), a single SINR
+ *   dimension covers every chunk length exactly.
+ */
+typedef struct
+{
+  double m_minDb;   ///< SINR (dB) of the first entry.
+  double m_maxDb;   ///< SINR (dB) of the last entry.
+  double m_stepDb;  ///< SINR spacing (dB) between entries.
+  std::vector<double> m_logSuccess;  ///< log(1 - BER) at each SINR.
+} Isa100ErrorModelTable;
+
 /**
  * \ingroup isa100-error-model
  *
  * Model the error rate for IEEE 802.15.4 in the AWGN channel.
+ *
+ * The success rate can either be calculated analytically for every chunk or
+ * read from a precomputed table (UseLookupTable attribute).  The table is
+ * linearly interpolated in dB and its spacing is refined until the chunk
+ * success rate is within MaxLookupError of the analytic value for chunks of
+ * up to MaxLookupBits bits.  Tables are built once and shared by every error
+ * model using the same accuracy bound.
  */
 class Isa100ErrorModel : public Object
 {
@@ -44,7 +66,62 @@ public:
    */
   double GetChunkSuccessRate (double snr, uint32_t nbits) const;
 
+  /**
+   * return chunk success rate for given SNR, always using the analytic expression
+   * \return success rate (i.e. 1 - chunk error rate)
+   * \param snr SNR expressed as a power ratio (i.e. not in dB)
+   * \param nbits number of bits in the chunk
+   */
+  double GetAnalyticChunkSuccessRate (double snr, uint32_t nbits) const;
+
+  /**
+   * Set the accuracy bound of the lookup table.  The model switches to the shared table
+   * for the new bound on its next lookup.
+   * \param maxError largest absolute error of the chunk success rate
+   */
+  void SetMaxLookupError (double maxError);
+
+  /**
+   * \return the accuracy bound of the lookup table
+   */
+  double GetMaxLookupError (void) const;
+
+  /**
+   * Set the longest chunk the lookup table accuracy bound must hold for.  The model
+   * switches to the shared table for the new length on its next lookup.
+   * \param maxBits chunk length (bits)
+   */
+  void SetMaxLookupBits (uint32_t maxBits);
+
+  /**
+   * \return the longest chunk (bits) the lookup table accuracy bound holds for
+   */
+  uint32_t GetMaxLookupBits (void) const;
+
+  /**
+   * \return the lookup table used by this model (built if required)
+   */
+  const Isa100ErrorModelTable* GetLookupTable (void) const;
+
 private:
+
+  /** Build a lookup table meeting the accuracy bound.
+   *
+   * @param maxError Largest allowed absolute error of the chunk success rate.
+   * @param maxBits Longest chunk (bits) the bound must hold for.
+   * @param table Table to fill.
+   */
+  void BuildLookupTable (double maxError, uint32_t maxBits, Isa100ErrorModelTable &table) const;
+
+  /**
+   * \return log(1 - BER) for the given linear SNR
+   */
+  double GetLogBitSuccess (double snr) const;
+
+  bool m_useTable;        ///< Use the lookup table instead of the analytic expression.
+  double m_maxError;      ///< Accuracy bound of the lookup table.
+  uint32_t m_maxBits;     ///< Longest chunk (bits) covered by the accuracy bound.
+  mutable const Isa100ErrorModelTable *m_table;  ///< Shared lookup table (found on first use, reset when the bound changes).
 };
 
 
@@ -171,6 +171,10 @@ void Isa100NetDevice::SetBattery (Ptr<Isa100Battery> battery)
 {
   NS_LOG_FUNCTION (this);
   m_battery = battery;
+
+  // Superframe boundaries for the aggregated energy trace.
+  if(m_dl)
+  	m_dl->SetDlFrameCompleteCallback( MakeCallback(&Isa100Battery::FrameComplete, m_battery) );
 }
 
 void Isa100NetDevice::SetProcessor (Ptr<Isa100Processor> processor)
@@ -189,8 +193,9 @@ void Isa100NetDevice::SetSensor (Ptr<Isa100Sensor> sensor)
 void Isa100NetDevice::SetChannel (Ptr<SpectrumChannel> channel)
 {
   NS_LOG_FUNCTION (this << channel);
-  m_phy->SetChannel (channel);
+  // Attach to the channel first so the PHY can report its band when the channel is set.
   channel->AddRx (m_phy);
+  m_phy->SetChannel (channel);
   CompleteConfig ();
 }
 
@@ -272,6 +277,9 @@ Isa100NetDevice::SetAddress (Address address)
 {
   NS_LOG_FUNCTION (this);
   m_dl->SetAttribute("Address",Mac16AddressValue(Mac16Address::ConvertFrom (address)));
+  m_phy->SetAddress (Mac16Address::ConvertFrom (address));
+  if (m_battery)
+    m_battery->SetDevicePointer (this);
 }
 
 Address
@@ -66,6 +66,7 @@ Isa100Processor::Isa100Processor ()
 {
   NS_LOG_FUNCTION (this);
 
+  // Must match the order of Isa100ProcessorState.
   int nTypes = 2;
   string energyTypes[] = {
   		"ProcessorActive",
@@ -74,7 +75,6 @@ Isa100Processor::Isa100Processor ()
 
   m_energyCategories.assign(energyTypes,energyTypes+nTypes);
 
-  m_lastUpdateTime = Seconds(0.0);
 
 /*  m_currentActive = 0;
   m_currentSleep = 0;
@@ -83,7 +83,6 @@ Isa100Processor::Isa100Processor ()
 
   m_state = PROCESSOR_SLEEP;
   m_current = 0;
-  m_energyCategory = "ProcessorSleep";
 }
 
 
@@ -100,10 +99,13 @@ Isa100Processor::GetEnergyCategories()
 }
 
 void
-Isa100Processor::SetBatteryCallback(BatteryDecrementCallback c)
+Isa100Processor::SetBatteryCallback(BatteryPowerDrawCallback c, const vector<uint32_t> &categoryIds)
 {
 	NS_LOG_FUNCTION(this);
-	m_batteryDecrementCallback = c;
+	NS_ASSERT(categoryIds.size() == m_energyCategories.size());
+	m_batteryCallback = c;
+	m_energyCategoryIds = categoryIds;
+	m_batteryCallback(m_energyCategoryIds[m_state], m_current * m_supplyVoltage * 1e6);
 }
 
 double
@@ -126,30 +128,23 @@ Isa100Processor::SetState(Isa100ProcessorState state)
 
 	NS_LOG_FUNCTION (this);
 
-  Time duration = Simulator::Now () - m_lastUpdateTime;
-  NS_ASSERT (duration.GetNanoSeconds () >= 0);
-
-  double energyConsumed = m_current * duration.GetSeconds() * m_supplyVoltage * 1e6;
-  if(!m_batteryDecrementCallback.IsNull())
-  	m_batteryDecrementCallback(m_energyCategory,energyConsumed);
-
-  NS_LOG_LOGIC(" Current state " << m_energyCategories[state] << ", consumed " << energyConsumed << " uJ in " << duration.GetMilliSeconds() << " ms");
+  NS_LOG_LOGIC(" Current state " << m_energyCategories[state]);
 
 	m_state = state;
-	m_lastUpdateTime = Simulator::Now();
 
 	switch(m_state)
 	{
 		case PROCESSOR_ACTIVE:
 			m_current = m_currentActive;
-			m_energyCategory = "ProcessorActive";
 			break;
 
 		case PROCESSOR_SLEEP:
 			m_current = m_currentSleep;
-			m_energyCategory = "ProcessorSleeping";
 			break;
 	}
+
+  if(!m_batteryCallback.IsNull())
+  	m_batteryCallback(m_energyCategoryIds[m_state], m_current * m_supplyVoltage * 1e6);
 }
 
 
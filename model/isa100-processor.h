@@ -67,11 +67,13 @@ public:
    */
   vector<string>& GetEnergyCategories();
 
-  /** Set the callback function to decrement battery energy.
+  /** Set the callback function used to report state changes to the battery.
+   * - The battery integrates the consumption, the current draw is reported immediately.
    *
    * @param c Callback function.
+   * @param categoryIds Battery IDs of the categories returned by GetEnergyCategories().
    */
-  void SetBatteryCallback(BatteryDecrementCallback c);
+  void SetBatteryCallback(BatteryPowerDrawCallback c, const vector<uint32_t> &categoryIds);
 
   /** Get active current.
    *
@@ -94,9 +96,10 @@ public:
 
 private:
 
-  vector<string> m_energyCategories; /// Energy consumption categories.
+  vector<string> m_energyCategories; /// Energy consumption categories (indexed by Isa100ProcessorState).
+  vector<uint32_t> m_energyCategoryIds; /// Battery ID of each energy consumption category.
 
-  BatteryDecrementCallback m_batteryDecrementCallback;  /// Callback function used to decrement battery energy.
+  BatteryPowerDrawCallback m_batteryCallback;  /// Callback function used to report the power drawn from the battery.
 
 	Isa100ProcessorState m_state; /// Processor state.
 
@@ -104,8 +107,6 @@ private:
   double m_currentActive; /// Active current (A).
   double m_currentSleep; /// Sleep current (A).
   double m_supplyVoltage; /// Supply voltage (V).
-  Time m_lastUpdateTime; /// Last time the energy consumption of the processor was updated.
-  string m_energyCategory; /// Current energy consumption category string.
 };
 
 #endif
@@ -26,6 +26,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/integer.h"
 #include "ns3/double.h"
+#include "ns3/pointer.h"
 #include "ns3/packet.h"
 #include "ns3/node-container.h"
 
@@ -37,6 +38,7 @@
 #include "ns3/isa100-battery.h"
 
 #include <iomanip>
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("Isa100Routing");
 
@@ -75,90 +77,185 @@ Isa100RoutingAlgorithm::~Isa100RoutingAlgorithm()
 }
 
 Mac16Address
-Isa100RoutingAlgorithm::AttemptAnotherLink(uint8_t destInd, std::vector<Mac16Address> attemptedLinks)
+Isa100RoutingAlgorithm::AttemptAnotherLink(Mac16Address destAddr, std::vector<Mac16Address> attemptedLinks)
 {
   return Mac16Address("ff:ff");
 }
 
-NS_OBJECT_ENSURE_REGISTERED (Isa100SourceRoutingAlgorithm);
+// --- Isa100SourceRouteTable ---
 
-// --- Isa100SourceRoutingAlgorithm ---
-TypeId Isa100SourceRoutingAlgorithm::GetTypeId (void)
+NS_OBJECT_ENSURE_REGISTERED (Isa100SourceRouteTable);
+
+TypeId Isa100SourceRouteTable::GetTypeId (void)
 {
-  static TypeId tid = TypeId ("ns3::Isa100SourceRoutingAlgorithm")
-    .SetParent<Isa100RoutingAlgorithm> ()
-    .AddConstructor<Isa100SourceRoutingAlgorithm> ()
+  static TypeId tid = TypeId ("ns3::Isa100SourceRouteTable")
+    .SetParent<Object> ()
+    .AddConstructor<Isa100SourceRouteTable> ()
 
     ;
 
   return tid;
 }
 
+Isa100SourceRouteTable::Isa100SourceRouteTable()
+{
+	;
+}
 
+Isa100SourceRouteTable::~Isa100SourceRouteTable()
+{
+	;
+}
 
-Isa100SourceRoutingAlgorithm::Isa100SourceRoutingAlgorithm(uint32_t numDests, std::string *initTable)
-:Isa100RoutingAlgorithm(),m_numDests(numDests)
+uint32_t Isa100SourceRouteTable::AddRoute(const std::vector<Mac16Address> &route)
 {
-  NS_LOG_FUNCTION(this);
+	NS_LOG_FUNCTION(this << route.size());
+
+	if(route.empty())
+		NS_FATAL_ERROR("Adding an empty source route.");
+
+	// Add the hops from the destination back to the first hop so routes with the same ending share entries.
+	uint32_t next = ISA100_ROUTE_NONE;
+
+	for(uint32_t iHop=route.size(); iHop-- > 0; ){
+
+		uint8_t buffer[2];
+		route[iHop].CopyTo(buffer);
+		std::pair<uint32_t, uint16_t> key(next, (buffer[0] << 8) | buffer[1]);
 
-  m_numHops = new uint32_t[m_numDests];
-  m_table = new Mac16Address*[m_numDests];
+		std::map<std::pair<uint32_t, uint16_t>, uint32_t>::iterator it = m_index.find(key);
+		if(it != m_index.end()){
+			next = it->second;
+			continue;
+		}
 
-  std::string addressStr;
+		Entry entry;
+		entry.m_addr = key.second;
+		entry.m_next = next;
+		m_entries.push_back(entry);
 
-  for(uint32_t iDest=0; iDest < m_numDests; iDest++){
+		next = m_entries.size() - 1;
+		m_index.insert(std::make_pair(key, next));
+	}
 
-    NS_LOG_DEBUG(" Dest: " << iDest);
+	return next;
+}
 
-  	// Determine the number of routing table entries by counting the semicolons
-  	int numEntries = 0;
-  	int startSearch = 0;
-  	while( ( startSearch = initTable[iDest].find(":",startSearch+1) ) != std::string::npos)
-  		numEntries++;
+Mac16Address Isa100SourceRouteTable::GetHop(uint32_t entry) const
+{
+	NS_ASSERT(entry < m_entries.size());
 
-  	NS_LOG_DEBUG(" Num Hop Entries: " << numEntries);
+	uint8_t buffer[2];
+	buffer[0] = m_entries[entry].m_addr >> 8;
+	buffer[1] = m_entries[entry].m_addr & 0xff;
 
-    // Each address string is 6 chars (address plus space) except the last one which is just address.
-    m_table[iDest] = new Mac16Address[numEntries];
+	Mac16Address addr;
+	addr.CopyFrom(buffer);
+	return addr;
+}
 
-    uint32_t iEnd, iHop = 0, iStart = 0;
-    for(iEnd=0; iEnd < initTable[iDest].length(); iEnd++){
+uint32_t Isa100SourceRouteTable::GetNext(uint32_t entry) const
+{
+	NS_ASSERT(entry < m_entries.size());
+	return m_entries[entry].m_next;
+}
+
+uint32_t Isa100SourceRouteTable::GetNumEntries(void) const
+{
+	return m_entries.size();
+}
 
-      if(initTable[iDest][iEnd] == ' '){
+std::vector<Mac16Address> Isa100SourceRouteTable::ParseRoute(const std::string &route)
+{
+	std::vector<Mac16Address> hops;
 
-        addressStr = initTable[iDest].substr(iStart,iEnd-iStart);
-        NS_LOG_DEBUG("  Hop: " << addressStr);
+	uint32_t iStart = 0;
+	for(uint32_t iEnd=0; iEnd <= route.length(); iEnd++){
 
-        m_table[iDest][iHop++] = Mac16Address( addressStr.c_str() );
-        iStart = iEnd+1;
-      }
-    }
+		if(iEnd == route.length() || route[iEnd] == ' '){
+			hops.push_back( Mac16Address( route.substr(iStart,iEnd-iStart).c_str() ) );
+			iStart = iEnd+1;
+		}
+	}
 
-    addressStr = initTable[iDest].substr(iStart,std::string::npos);
+	return hops;
+}
 
-    NS_LOG_DEBUG("  Hop: " << addressStr);
-    m_table[iDest][iHop++] = Mac16Address( addressStr.c_str() );
 
-    m_numHops[iDest] = iHop;
+NS_OBJECT_ENSURE_REGISTERED (Isa100SourceRoutingAlgorithm);
 
-    NS_LOG_DEBUG("  Total Hops: " << m_numHops[iDest]);
+// --- Isa100SourceRoutingAlgorithm ---
+TypeId Isa100SourceRoutingAlgorithm::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Isa100SourceRoutingAlgorithm")
+    .SetParent<Isa100RoutingAlgorithm> ()
+    .AddConstructor<Isa100SourceRoutingAlgorithm> ()
+
+    .AddAttribute ("RouteTable","Table storing the source routes, can be shared by several nodes.",
+        PointerValue(),
+        MakePointerAccessor(&Isa100SourceRoutingAlgorithm::m_table),
+        MakePointerChecker<Isa100SourceRouteTable>())
+
+    ;
+
+  return tid;
+}
+
+
+
+Isa100SourceRoutingAlgorithm::Isa100SourceRoutingAlgorithm(uint32_t numDests, std::string *initTable)
+:Isa100RoutingAlgorithm()
+{
+  NS_LOG_FUNCTION(this);
+
+  m_table = CreateObject<Isa100SourceRouteTable>();
+
+  for(uint32_t iDest=0; iDest < numDests; iDest++){
+
+    NS_LOG_DEBUG(" Dest: " << iDest << ", Route: " << initTable[iDest]);
+
+    uint8_t buffer[2];
+    buffer[0] = iDest >> 8;
+    buffer[1] = iDest & 0xff;
+    Mac16Address dest;
+    dest.CopyFrom(buffer);
+
+    SetRoute(dest, Isa100SourceRouteTable::ParseRoute(initTable[iDest]));
   }
 }
 
+Isa100SourceRoutingAlgorithm::Isa100SourceRoutingAlgorithm(Ptr<Isa100SourceRouteTable> table)
+:Isa100RoutingAlgorithm(),m_table(table)
+{
+	;
+}
+
 Isa100SourceRoutingAlgorithm::Isa100SourceRoutingAlgorithm()
 :Isa100RoutingAlgorithm()
 {
-	m_table = 0;
-	m_numDests = 0;
-	m_numHops = 0;
+	;
 }
 
 Isa100SourceRoutingAlgorithm::~Isa100SourceRoutingAlgorithm()
 {
-	for(uint32_t iDel=0; iDel < m_numDests; iDel++)
-		delete[] m_table[iDel];
-	delete[] m_table;
-	delete[] m_numHops;
+	;
+}
+
+void Isa100SourceRoutingAlgorithm::SetRoute(Mac16Address dest, const std::vector<Mac16Address> &route)
+{
+	NS_LOG_FUNCTION(this << dest);
+
+	if(!m_table)
+		m_table = CreateObject<Isa100SourceRouteTable>();
+
+	uint8_t buffer[2];
+	dest.CopyTo(buffer);
+	uint16_t destNodeInd = (buffer[0] << 8) | buffer[1];
+
+	if(destNodeInd >= m_routes.size())
+		m_routes.resize(destNodeInd + 1, ISA100_ROUTE_NONE);
+
+	m_routes[destNodeInd] = m_table->AddRoute(route);
 }
 
 
@@ -166,20 +263,24 @@ void Isa100SourceRoutingAlgorithm::PrepTxPacketHeader(Isa100DlHeader &header)
 {
 	NS_LOG_FUNCTION(this);
 
-	uint8_t buffer[4];
+	uint8_t buffer[2];
 	Mac16Address addr = header.GetDaddrDestAddress();
 	addr.CopyTo(buffer);
 
 	// Populate DROUT sub-header.
-	uint8_t destNodeInd = buffer[1];
-	NS_LOG_DEBUG(" Sending to node " << static_cast<uint16_t>(destNodeInd));
+	uint16_t destNodeInd = (buffer[0] << 8) | buffer[1];
+	NS_LOG_DEBUG(" Sending to node " << destNodeInd);
 
-	for(uint32_t iHop=0; iHop < m_numHops[destNodeInd]; iHop++)
-		header.SetSourceRouteHop(iHop,m_table[destNodeInd][iHop]);
+	if(destNodeInd >= m_routes.size() || m_routes[destNodeInd] == ISA100_ROUTE_NONE)
+		NS_FATAL_ERROR("No source route from " << m_address << " to " << addr);
+
+	uint32_t iHop = 0;
+	for(uint32_t entry=m_routes[destNodeInd]; entry != ISA100_ROUTE_NONE; entry = m_table->GetNext(entry))
+		header.SetSourceRouteHop(iHop++,m_table->GetHop(entry));
 
 	// Set header for first hop.
 	header.SetSrcAddrFields(0,m_address);
-	header.SetDstAddrFields(0,m_table[destNodeInd][0]);
+	header.SetDstAddrFields(0,m_table->GetHop(m_routes[destNodeInd]));
 
 
 }
@@ -216,5 +317,138 @@ void Isa100SourceRoutingAlgorithm::ProcessRxPacket(Ptr<Packet> packet, bool &for
 
 
 
+// --- Isa100GraphRoutingAlgorithm ---
+
+NS_OBJECT_ENSURE_REGISTERED (Isa100GraphRoutingAlgorithm);
+
+TypeId Isa100GraphRoutingAlgorithm::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Isa100GraphRoutingAlgorithm")
+    .SetParent<Isa100RoutingAlgorithm> ()
+    .AddConstructor<Isa100GraphRoutingAlgorithm> ()
+
+    ;
+
+  return tid;
+}
+
+Isa100GraphRoutingAlgorithm::Isa100GraphRoutingAlgorithm()
+:Isa100RoutingAlgorithm()
+{
+	;
+}
+
+Isa100GraphRoutingAlgorithm::~Isa100GraphRoutingAlgorithm()
+{
+	;
+}
+
+void Isa100GraphRoutingAlgorithm::SetGraph(uint16_t graphId, std::vector<Mac16Address> nextHops)
+{
+	NS_LOG_FUNCTION(this << graphId);
+
+	if(nextHops.empty())
+		NS_FATAL_ERROR("Graph " << graphId << " at " << m_address << " has no next hops.");
+
+	m_graphs[graphId] = nextHops;
+}
+
+void Isa100GraphRoutingAlgorithm::SetDestinationGraph(Mac16Address dest, uint16_t graphId)
+{
+	NS_LOG_FUNCTION(this << dest << graphId);
+
+	m_destGraphs[dest] = graphId;
+}
+
+const std::vector<Mac16Address> & Isa100GraphRoutingAlgorithm::GetNextHops(uint16_t graphId) const
+{
+	std::map<uint16_t, std::vector<Mac16Address> >::const_iterator it = m_graphs.find(graphId);
+
+	if(it == m_graphs.end())
+		NS_FATAL_ERROR("Graph " << graphId << " is not configured at " << m_address);
+
+	return it->second;
+}
+
+void Isa100GraphRoutingAlgorithm::PrepTxPacketHeader(Isa100DlHeader &header)
+{
+	NS_LOG_FUNCTION(this);
+
+	Mac16Address addr = header.GetDaddrDestAddress();
+
+	std::map<Mac16Address, uint16_t>::iterator it = m_destGraphs.find(addr);
+	if(it == m_destGraphs.end())
+		NS_FATAL_ERROR("No graph route from " << m_address << " to " << addr);
+
+	uint16_t graphId = it->second;
+	NS_LOG_DEBUG(" Sending to " << addr << " on graph " << graphId);
+
+	// Populate DROUT sub-header with the graph route entry.
+	uint8_t buffer[2];
+	buffer[0] = graphId >> 8;
+	buffer[1] = graphId & 0xff;
+	Mac16Address graphEntry;
+	graphEntry.CopyFrom(buffer);
+	header.SetSourceRouteHop(0,graphEntry);
+	header.SetGraphRoute(true);
+
+	// Set header for first hop.
+	header.SetSrcAddrFields(0,m_address);
+	header.SetDstAddrFields(0,GetNextHops(graphId)[0]);
+}
+
+void Isa100GraphRoutingAlgorithm::ProcessRxPacket(Ptr<Packet> packet, bool &forwardPacketOn)
+{
+	NS_LOG_FUNCTION(this << m_address);
+
+	// Remove the header so that it can be modified.
+	Isa100DlHeader header;
+	packet->RemoveHeader(header);
+
+	Mac16Address finalDestAddr = header.GetDaddrDestAddress();
+	forwardPacketOn = (m_address != finalDestAddr);
+
+	if(forwardPacketOn){
+
+		if(!header.IsGraphRoute() || !header.GetNumSourceRouteHops())
+			NS_FATAL_ERROR("Packet forwarded by " << m_address << " has no graph route entry.");
+
+		uint8_t buffer[2];
+		header.GetSourceRouteHop(0).CopyTo(buffer);
+		uint16_t graphId = (buffer[0] << 8) | buffer[1];
+
+		// Remember the graph so a failed transmission toward this destination can be rerouted.
+		m_destGraphs[finalDestAddr] = graphId;
+
+		Mac16Address nextHopAddr = GetNextHops(graphId)[0];
+		NS_LOG_DEBUG(" Final Dest Addr: " << finalDestAddr << ", Graph: " << graphId << ", Next Hop Addr: " << nextHopAddr);
+
+		// Set MHR source and destination addresses for next hop.
+		header.SetSrcAddrFields(0,m_address);
+		header.SetDstAddrFields(0,nextHopAddr);
+	}
+
+	// Return the modified header to the packet.
+	packet->AddHeader(header);
+}
+
+Mac16Address Isa100GraphRoutingAlgorithm::AttemptAnotherLink(Mac16Address destAddr, std::vector<Mac16Address> attemptedLinks)
+{
+	NS_LOG_FUNCTION(this << destAddr);
+
+	std::map<Mac16Address, uint16_t>::iterator it = m_destGraphs.find(destAddr);
+	if(it == m_destGraphs.end())
+		return Mac16Address("ff:ff");
+
+	const std::vector<Mac16Address> &nextHops = GetNextHops(it->second);
+
+	for(uint32_t i=0; i < nextHops.size(); i++){
+		if(std::find(attemptedLinks.begin(), attemptedLinks.end(), nextHops[i]) == attemptedLinks.end())
+			return nextHops[i];
+	}
+
+	return Mac16Address("ff:ff");
+}
+
 
 } // namespace ns3
@@ -27,6 +27,12 @@
 #include "ns3/object.h"
 #include "ns3/mac16-address.h"
 
+#include <vector>
+#include <map>
+
+/** Route table entry index indicating the end of a route (or no route). */
+#define ISA100_ROUTE_NONE 0xFFFFFFFF
+
 namespace ns3 {
 class NodeContainer;
 class Packet;
@@ -61,12 +67,12 @@ public:
   /** Determine if it's possible to attempt another link, given that a transmission has failed
    *   - This function should be overridden if used
    *
-   * @param destInd The index of the final destination node
+   * @param destAddr The address of the final destination node
    * @param attempedLinks A list of already attempted links
    *
    * @return The base function always returns ff:ff
    */
-  virtual Mac16Address AttemptAnotherLink(uint8_t destInd, std::vector<Mac16Address> attemptedLinks);
+  virtual Mac16Address AttemptAnotherLink(Mac16Address destAddr, std::vector<Mac16Address> attemptedLinks);
 
 
 protected:
@@ -75,6 +81,68 @@ protected:
 
 };
 
+/** Network wide store of source routes.
+ * - Routes are kept as a parent pointer tree: each entry holds one hop address and the index of the entry
+ *   for the rest of the route.  Routes that end with the same hops share those entries, so the routes of a
+ *   whole network toward the sink take about one entry per node.
+ * - A route is referenced by the index of its first entry.  One table is normally shared by the routing
+ *   algorithms of every node.
+ */
+class Isa100SourceRouteTable : public Object
+{
+public:
+
+  static TypeId GetTypeId (void);
+
+  Isa100SourceRouteTable();
+
+  ~Isa100SourceRouteTable();
+
+  /** Add a route to the table.
+   *
+   * @param route Hop addresses from the first hop to the final destination.
+   * @return Index of the first entry of the route.
+   */
+  uint32_t AddRoute(const std::vector<Mac16Address> &route);
+
+  /** Get the hop address of an entry.
+   *
+   * @param entry Entry index.
+   */
+  Mac16Address GetHop(uint32_t entry) const;
+
+  /** Get the entry for the rest of the route.
+   *
+   * @param entry Entry index.
+   * @return Entry index, ISA100_ROUTE_NONE if the entry is the final destination.
+   */
+  uint32_t GetNext(uint32_t entry) const;
+
+  /** Get the number of entries stored for all routes.
+   *
+   */
+  uint32_t GetNumEntries(void) const;
+
+  /** Convert a route string to a list of addresses.
+   *
+   * @param route Addresses in XX:XX format separated by single spaces.
+   */
+  static std::vector<Mac16Address> ParseRoute(const std::string &route);
+
+private:
+
+  /** One hop of a route.
+   */
+  struct Entry
+  {
+    uint16_t m_addr;  ///< Hop address.
+    uint32_t m_next;  ///< Entry for the rest of the route.
+  };
+
+  std::vector<Entry> m_entries;  ///< All route entries.
+  std::map<std::pair<uint32_t, uint16_t>, uint32_t> m_index;  ///< Entry holding each (next entry, address) pair, used to share route endings.
+};
+
 class Isa100SourceRoutingAlgorithm : public Isa100RoutingAlgorithm
 {
 public:
@@ -84,6 +152,13 @@ public:
   Isa100SourceRoutingAlgorithm();
 
   /** Constructor.
+   *
+   * @param table Route table shared with other nodes.
+   */
+  Isa100SourceRoutingAlgorithm(Ptr<Isa100SourceRouteTable> table);
+
+  /** Constructor.
+   * - The routes are stored in a route table used only by this node.
    *
    * @param initNumDests The number of destinations the node can reach using source routing.
    * @param initTable Array of strings containing the multi-hop paths to reach each destination.  Each address is a string in XX:XX format.
@@ -92,6 +167,14 @@ public:
 
   ~Isa100SourceRoutingAlgorithm();
 
+  /** Set the route to a destination.
+   * - The route is added to the route table (one is created if none was set).
+   *
+   * @param dest Final destination address.
+   * @param route Hop addresses from the first hop to the final destination.
+   */
+  void SetRoute(Mac16Address dest, const std::vector<Mac16Address> &route);
+
   /** Populate header at source with any information required by routing algorithm.
    * - Only works if the header contains a valid destination address.
    *
@@ -110,9 +193,79 @@ public:
 
 private:
 
-  Mac16Address **m_table;
-  uint32_t m_numDests;
-  uint32_t *m_numHops;
+  Ptr<Isa100SourceRouteTable> m_table;  ///< Table storing the routes.
+  std::vector<uint32_t> m_routes;  ///< First route table entry for each destination node index (ISA100_ROUTE_NONE if no route).
+
+};
+
+/** ISA100 style graph routing.
+ * - A graph is an ordered list of next hop neighbours.  The first neighbour is preferred and the rest are
+ *   alternates.  Each destination is reached through one graph.
+ * - The graph ID travels in the DROUT sub-header as a single route entry, flagged with
+ *   Isa100DlHeader::SetGraphRoute() so it can't be mistaken for a node address.  Every node on the path
+ *   forwards the packet using its own next hops for that graph.
+ * - When a transmission fails, the DL calls AttemptAnotherLink() to move the packet to an alternate
+ *   neighbour that hasn't been tried yet.
+ */
+class Isa100GraphRoutingAlgorithm : public Isa100RoutingAlgorithm
+{
+public:
+
+  static TypeId GetTypeId (void);
+
+  Isa100GraphRoutingAlgorithm();
+
+  ~Isa100GraphRoutingAlgorithm();
+
+  /** Set the next hops of a graph.
+   *
+   * @param graphId Graph ID.
+   * @param nextHops Next hop neighbours in order of preference.
+   */
+  void SetGraph(uint16_t graphId, std::vector<Mac16Address> nextHops);
+
+  /** Set the graph used to reach a destination.
+   * - Forwarding nodes learn this from the packets they route, so it only has to be set at the source.
+   *
+   * @param dest Final destination address.
+   * @param graphId Graph ID.
+   */
+  void SetDestinationGraph(Mac16Address dest, uint16_t graphId);
+
+  /** Populate header at source with the graph ID and first hop.
+   * - Only works if the header contains a valid destination address.
+   *
+   * @param header The header object to be worked on.
+   */
+  void PrepTxPacketHeader(Isa100DlHeader &header);
+
+  /** Process a received packet to determine if it needs to be forwarded.
+   * - If it does need to be forwarded on, the MHR addresses are set for the preferred next hop of the graph.
+   *
+   * @param packet Pointer to the received packet.
+   * @param forwardPacketOn Reference to boolean that is true if the packet must be sent onward.
+   */
+  void ProcessRxPacket(Ptr<Packet> packet, bool &forwardPacketOn);
+
+  /** Get the most preferred next hop toward a destination that hasn't been attempted.
+   *
+   * @param destAddr The address of the final destination node
+   * @param attemptedLinks A list of already attempted links
+   *
+   * @return Next hop address, ff:ff if every neighbour in the graph has been attempted.
+   */
+  Mac16Address AttemptAnotherLink(Mac16Address destAddr, std::vector<Mac16Address> attemptedLinks);
+
+private:
+
+  /** Get the next hops of a graph.
+   *
+   * @param graphId Graph ID.
+   */
+  const std::vector<Mac16Address> &GetNextHops(uint16_t graphId) const;
+
+  std::map<uint16_t, std::vector<Mac16Address> > m_graphs; ///< Next hops of each graph, in order of preference.
+  std::map<Mac16Address, uint16_t> m_destGraphs; ///< Graph used to reach each destination.
 
 };
 
@@ -76,6 +76,7 @@ Isa100Sensor::Isa100Sensor ()
 {
   NS_LOG_FUNCTION (this);
 
+  // Must match the order of Isa100SensorState.
   int nTypes = 2;
   string energyTypes[] = {
   		"SensorActive",
@@ -84,7 +85,6 @@ Isa100Sensor::Isa100Sensor ()
 
   m_energyCategories.assign(energyTypes,energyTypes+nTypes);
 
-  m_lastUpdateTime = Seconds(0.0);
   m_sensingTime = Seconds(0.0);
 
   m_currentActive = 0;
@@ -93,7 +93,6 @@ Isa100Sensor::Isa100Sensor ()
 
   m_state = SENSOR_IDLE;
   m_current = m_currentIdle;
-  m_energyCategory = "SensorIdle";
 }
 
 
@@ -110,10 +109,13 @@ Isa100Sensor::GetEnergyCategories()
 }
 
 void
-Isa100Sensor::SetBatteryCallback(BatteryDecrementCallback c)
+Isa100Sensor::SetBatteryCallback(BatteryPowerDrawCallback c, const vector<uint32_t> &categoryIds)
 {
 	NS_LOG_FUNCTION(this);
-	m_batteryDecrementCallback = c;
+	NS_ASSERT(categoryIds.size() == m_energyCategories.size());
+	m_batteryCallback = c;
+	m_energyCategoryIds = categoryIds;
+	m_batteryCallback(m_energyCategoryIds[m_state], m_current * m_supplyVoltage * 1e6);
 }
 
 void
@@ -126,6 +128,9 @@ void
 Isa100Sensor::SetSupplyVoltage(double voltage)
 {
 	m_supplyVoltage = voltage;
+
+  if(!m_batteryCallback.IsNull())
+  	m_batteryCallback(m_energyCategoryIds[m_state], m_current * m_supplyVoltage * 1e6);
 }
 
 void
@@ -158,30 +163,23 @@ Isa100Sensor::SetState(Isa100SensorState state)
 
 	NS_LOG_FUNCTION (this);
 
-  Time duration = Simulator::Now () - m_lastUpdateTime;
-  NS_ASSERT (duration.GetNanoSeconds () >= 0);
-
-  double energyConsumed = m_current * duration.GetSeconds() * m_supplyVoltage * 1e6 ;
-  if(!m_batteryDecrementCallback.IsNull())
-  	m_batteryDecrementCallback(m_energyCategory,energyConsumed);
-
-  NS_LOG_LOGIC(" State " << m_energyCategories[m_state] << " to "<< m_energyCategories[state] << ", after: " << duration.GetSeconds() << "s, consumed " << energyConsumed << " uJ");
+  NS_LOG_LOGIC(" State " << m_energyCategories[m_state] << " to "<< m_energyCategories[state]);
 
   m_state = state;
-  m_lastUpdateTime = Simulator::Now();
 
 	switch(m_state)
 	{
 		case SENSOR_ACTIVE:
 			m_current = m_currentActive;
-			m_energyCategory = "SensorActive";
 			break;
 
 		case SENSOR_IDLE:
 			m_current = m_currentIdle;
-			m_energyCategory = "SensorIdle";
 			break;
 	}
+
+  if(!m_batteryCallback.IsNull())
+  	m_batteryCallback(m_energyCategoryIds[m_state], m_current * m_supplyVoltage * 1e6);
 }
 
 void Isa100Sensor::SetSensingCallback(SensingCallback c)
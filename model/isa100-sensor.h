@@ -65,11 +65,13 @@ public:
    */
   vector<string>& GetEnergyCategories();
 
-  /** Set the callback function to decrement battery energy.
+  /** Set the callback function used to report state changes to the battery.
+   * - The battery integrates the consumption, the current draw is reported immediately.
    *
    * @param c Callback function.
+   * @param categoryIds Battery IDs of the categories returned by GetEnergyCategories().
    */
-  void SetBatteryCallback(BatteryDecrementCallback c);
+  void SetBatteryCallback(BatteryPowerDrawCallback c, const vector<uint32_t> &categoryIds);
 
   /** Set active current.
    *
@@ -115,9 +117,10 @@ private:
    */
   void EndSensing();
 
-  vector<string> m_energyCategories; /// Energy consumption categories.
+  vector<string> m_energyCategories; /// Energy consumption categories (indexed by Isa100SensorState).
+  vector<uint32_t> m_energyCategoryIds; /// Battery ID of each energy consumption category.
 
-  BatteryDecrementCallback m_batteryDecrementCallback;  /// Callback function used to decrement battery energy.
+  BatteryPowerDrawCallback m_batteryCallback;  /// Callback function used to report the power drawn from the battery.
 
 	Isa100SensorState m_state; /// Sensor state.
 
@@ -129,8 +132,6 @@ private:
   SensingCallback m_sensingCallback;  /// Function called when the sensing operation completes.
 
   Time m_sensingTime; /// Time required to perform the sensing operation.
-  Time m_lastUpdateTime; /// Last time the energy consumption of the processor was updated.
-  string m_energyCategory; /// Current energy consumption category string.
 };
 
 #endif
@@ -37,6 +37,7 @@
 #include "fish-wpan-spectrum-signal-parameters.h"
 #include "isa100-error-model.h"
 #include "fish-wpan-spectrum-value-helper.h"
+#include "fish-spectrum-channel.h"
 #include "ns3/net-device.h"
 #include "ns3/packet.h"
 #include "ns3/antenna-model.h"
@@ -45,6 +46,8 @@
 #include "ns3/packet-burst.h"
 
 #include <iomanip>
+#include <limits>
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("ZigbeePhy");
 
@@ -56,6 +59,20 @@ NS_OBJECT_ENSURE_REGISTERED (ZigbeePhy);
 const char * ZigbeePhyEnumNames[] = {"BUSY","BUSY_RX","BUSY_TX","FORCE_TRX_OFF","IDLE","INVALID_PARAM","RX_ON","SUCCESS",
                                      "TRX_OFF","TX_ON","UNSUPPORTED_ATTRIBUTE","READ_ONLY","UNSPECIFIED","SLEEP"};
 
+// Descriptions of the PhyTaskTrace events, including the meaning of the traced value
+const char * ZigbeePhyTaskEventNames[] = {"Phy ended",
+                                          "Packet arrived at receiver (value: rx power dBm)",
+                                          "Started receiving the packet from the channel",
+                                          "Finished receiving a packet from the channel",
+                                          "Requested to transmit a packet",
+                                          "Started transmitting a packet",
+                                          "Finished transmitting a packet",
+                                          "Requested to perform CCA",
+                                          "Finished CCA",
+                                          "Requested to change state (value: ZigbeePhyEnumeration)",
+                                          "Changing the channel (value: new channel)",
+                                          "Setting the transmit power (value: dBm)"};
+
 // Table 22 in section 6.4.1 of ieee802.15.4
 const uint32_t ZigbeePhy::aMaxPhyPacketSize = 127; // max PSDU in octets
 const uint32_t ZigbeePhy::aTurnaroundTime = 12;  // RX-to-TX or TX-to-RX in symbol periods
@@ -158,7 +175,7 @@ ZigbeePhy::GetTypeId (void)
     .AddTraceSource("PhyTaskTrace",
                     " Trace source tracking Phy tasks",
                     MakeTraceSourceAccessor (&ZigbeePhy::m_phyTaskTrace),
-                    "ns3::TracedCallback::PhyInfo")
+                    "ns3::ZigbeePhy::TaskEventTracedCallback")
   ;
   return tid;
 }
@@ -183,15 +200,21 @@ ZigbeePhy::ZigbeePhy ()
     }
   m_phyPIBAttributes.phyCCAMode = 2;
 
-  m_rxEdPeakPower = 0.0;
-  m_rxTotalPower = 4.0;  // TxPower in dBm.
-  m_rxTotalNum = 0;
-
   FishWpanSpectrumValueHelper psdHelper;
-  m_txPsd = psdHelper.CreateTxPowerSpectralDensity (m_phyPIBAttributes.phyTransmitPower,
-                                                    m_phyPIBAttributes.phyCurrentChannel);
+  UpdateTxPsd ();
   m_noise = psdHelper.CreateNoisePowerSpectralDensity (m_phyPIBAttributes.phyCurrentChannel);
   m_rxPsd = 0;
+
+  m_rxEdPeakPower = 0.0;
+  m_rxTotalNum = 0;
+
+  m_rxSignalId = 0;
+  m_rxSignalPowerSum = 0.0;
+  UpdateNoisePower ();
+  m_currentRxSignalId = 0;
+  m_currentRxPower = 0.0;
+  m_rxChunkSuccess = 1.0;
+  m_rxMinSinr = 0.0;
   Ptr <Packet> none = 0;
   m_currentRxPacket.m_packet = 0;
   m_currentRxPacket.m_isCorrupt = false;
@@ -202,7 +225,8 @@ ZigbeePhy::ZigbeePhy ()
 	m_random = CreateObject<UniformRandomVariable>();
 
 
-  int nTypes = 7;
+  // Must match the order of ZigbeePhyEnergyCategory.
+  int nTypes = 9;
   string energyTypes[] = {
   		"Broadcast",
   		"Data",
@@ -210,13 +234,16 @@ ZigbeePhy::ZigbeePhy ()
   		"BusyRx",
   		"RxOn",
   		"TxOn",
-  		"TrxOff"
+  		"TrxOff",
+  		"BusyTx",
+  		"PhySleep"
   };
 
   m_energyCategories.assign(energyTypes,energyTypes+nTypes);
 
+  m_current = 0;
+  m_energyCategory = PHY_ENERGY_TRX_OFF;
   m_supplyVoltage = 0;
-  m_lastUpdateTime = Seconds(0.0);
 }
 
 ZigbeePhy::~ZigbeePhy ()
@@ -227,7 +254,7 @@ void
 ZigbeePhy::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
-  m_phyTaskTrace(Mac16Address::ConvertFrom(m_device->GetAddress()), "Phy ended");
+  m_phyTaskTrace(m_address, PHY_TASK_ENDED, 0);
 
   m_mobility = 0;
   m_device = 0;
@@ -235,6 +262,7 @@ ZigbeePhy::DoDispose ()
   m_txPsd = 0;
   m_rxPsd = 0;
   m_noise = 0;
+  m_rxSignals.clear ();
   m_errorModel = 0;
   m_pdDataIndicationCallback = MakeNullCallback< void, uint32_t, Ptr<Packet>, uint32_t, double > ();
   m_pdDataConfirmCallback = MakeNullCallback< void, ZigbeePhyEnumeration > ();
@@ -270,6 +298,14 @@ ZigbeePhy::SetDevice (Ptr<NetDevice> d)
 {
   NS_LOG_FUNCTION (this << d);
   m_device = d;
+  m_address = Mac16Address::ConvertFrom (d->GetAddress ());
+}
+
+void
+ZigbeePhy::SetAddress (Mac16Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  m_address = address;
 }
 
 
@@ -286,6 +322,44 @@ ZigbeePhy::SetChannel (Ptr<SpectrumChannel> c)
 {
   NS_LOG_FUNCTION (this << c);
   m_channel = c;
+  UpdateChannelRxBand ();
+}
+
+void
+ZigbeePhy::UpdateChannelRxBand (void)
+{
+  Ptr<FishSpectrumChannel> fishChannel = DynamicCast<FishSpectrumChannel> (m_channel);
+  if (fishChannel)
+    {
+      std::vector<Ptr<SpectrumSignalParameters> > missed = fishChannel->SetRxBand (this, m_phyPIBAttributes.phyCurrentChannel - 11);
+      for (uint32_t i = 0; i < missed.size (); i++)
+        AddRxInterference (missed[i]);
+    }
+}
+
+void
+ZigbeePhy::AddRxInterference (Ptr<SpectrumSignalParameters> spectrumRxParams)
+{
+  NS_LOG_FUNCTION (this << spectrumRxParams);
+
+  // The SINR of any frame being received changes when the signal joins the medium.
+  UpdateRxChunk ();
+
+  double linNoiseFloor = pow(10.0, m_noiseFloorDbm / 10.0) / 1000.0;
+
+  ZigbeeRxSignal signal;
+  signal.m_id = m_rxSignalId++;
+  signal.m_psd = spectrumRxParams->psd;
+  signal.m_inBandPower = FishWpanSpectrumValueHelper::InBandPower (*signal.m_psd, m_phyPIBAttributes.phyCurrentChannel);
+  signal.m_isDetectable = signal.m_inBandPower >= linNoiseFloor;
+  m_rxSignals.push_back (signal);
+
+  m_rxSignalPowerSum += signal.m_inBandPower;
+  m_rxTotalPower = m_noisePower + m_rxSignalPowerSum;
+  if (signal.m_isDetectable)
+    m_rxTotalNum++;
+
+  Simulator::Schedule (spectrumRxParams->duration, &ZigbeePhy::EndRxSignal, this, signal.m_id);
 }
 
 
@@ -328,15 +402,88 @@ ZigbeePhy::GetEnergyCategories()
 	return m_energyCategories;
 }
 
-void ZigbeePhy::DecrementChannelRxSignals()
+void ZigbeePhy::EndRxSignal (uint32_t signalId)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << signalId);
+
+  // The SINR changes when this signal leaves the medium.
+  UpdateRxChunk ();
+
+  for (uint32_t i = 0; i < m_rxSignals.size (); i++){
+  	if (m_rxSignals[i].m_id != signalId)
+  		continue;
 
-	m_rxTotalNum--;
+  	m_rxSignalPowerSum -= m_rxSignals[i].m_inBandPower;
+  	if (m_rxSignals[i].m_isDetectable)
+  		m_rxTotalNum--;
+
+  	// Order of the active signals does not matter.
+  	m_rxSignals[i] = m_rxSignals.back ();
+  	m_rxSignals.pop_back ();
+  	break;
+  }
+
+  // Avoid accumulating round off error once the medium is empty.
+  if (m_rxSignals.empty ())
+  	m_rxSignalPowerSum = 0.0;
+
+  m_rxTotalPower = m_noisePower + m_rxSignalPowerSum;
 
   NS_LOG_LOGIC(" Number of 802.15.4 signals in channel decremented to " << m_rxTotalNum);
 }
 
+void ZigbeePhy::UpdateRxChunk (void)
+{
+  if (!m_currentRxPacket.m_packet)
+  	return;
+
+  Time chunkDuration = Simulator::Now () - m_rxChunkStart;
+  if (chunkDuration.IsZero ())
+  	return;
+
+  // Interference is despread along with the noise, so the spreading gain applies to both.
+  double noiseFactor = pow(10.0, m_noiseFigureDbm / 10.0);
+  double interference = std::max (0.0, m_rxSignalPowerSum - m_currentRxPower);
+  double sinr = m_currentRxPower / (m_noisePower * noiseFactor + interference) * spreadingGain;
+
+  uint32_t nbits = (uint32_t)(chunkDuration.GetSeconds () * m_bitRate + 0.5);
+
+  if (m_errorModel != 0 && nbits > 0)
+  	m_rxChunkSuccess *= m_errorModel->GetChunkSuccessRate (sinr, nbits);
+
+  if (sinr < m_rxMinSinr)
+  	m_rxMinSinr = sinr;
+
+  NS_LOG_LOGIC(" Rx chunk: " << nbits << " bits at SINR " << 10*log10(sinr) << " dB, success so far " << m_rxChunkSuccess);
+
+  m_rxChunkStart = Simulator::Now ();
+}
+
+void ZigbeePhy::RecalculateRxSignalPower (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  double linNoiseFloor = pow(10.0, m_noiseFloorDbm / 10.0) / 1000.0;
+
+  // The signal of a frame being received is in the list too, so its power follows the new band as well.
+  if (m_currentRxPacket.m_packet)
+  	m_currentRxPower = 0.0;
+
+  m_rxSignalPowerSum = 0.0;
+  m_rxTotalNum = 0;
+  for (uint32_t i = 0; i < m_rxSignals.size (); i++){
+  	m_rxSignals[i].m_inBandPower = FishWpanSpectrumValueHelper::InBandPower (*m_rxSignals[i].m_psd, m_phyPIBAttributes.phyCurrentChannel);
+  	m_rxSignals[i].m_isDetectable = m_rxSignals[i].m_inBandPower >= linNoiseFloor;
+  	m_rxSignalPowerSum += m_rxSignals[i].m_inBandPower;
+  	if (m_rxSignals[i].m_isDetectable)
+  		m_rxTotalNum++;
+  	if (m_currentRxPacket.m_packet && m_rxSignals[i].m_id == m_currentRxSignalId)
+  		m_currentRxPower = m_rxSignals[i].m_inBandPower;
+  }
+
+  m_rxTotalPower = m_noisePower + m_rxSignalPowerSum;
+}
+
 void
 ZigbeePhy::StartRx (Ptr<SpectrumSignalParameters> spectrumRxParams)
 {
@@ -346,13 +493,9 @@ ZigbeePhy::StartRx (Ptr<SpectrumSignalParameters> spectrumRxParams)
   if (m_trxState == PHY_SLEEP)
     return;
 
-  double rxPowerDbm = 10*log10((*(spectrumRxParams->psd))[m_phyPIBAttributes.phyCurrentChannel - 11]*2.0e6*1000);
-  std::stringstream ss;
-  ss << "Packet arrived at receiver, Rx Power: " << rxPowerDbm << " dBm";
-  std::string msg = ss.str();
-  m_phyTaskTrace(Mac16Address::ConvertFrom(m_device->GetAddress()), msg);
-
-  FishWpanSpectrumValueHelper psdHelper;
+  double rxPower = FishWpanSpectrumValueHelper::InBandPower (*(spectrumRxParams->psd), m_phyPIBAttributes.phyCurrentChannel);
+  double rxPowerDbm = 10*log10(rxPower*1000);
+  m_phyTaskTrace(m_address, PHY_TASK_RX_ARRIVED, rxPowerDbm);
 
   // Copy in the received signal information and the packet (all contained in ZigbeeSpectrumSignalParameters).
   Ptr<FishWpanSpectrumSignalParameters> lrWpanRxParams = DynamicCast<FishWpanSpectrumSignalParameters> (spectrumRxParams);
@@ -360,9 +503,30 @@ ZigbeePhy::StartRx (Ptr<SpectrumSignalParameters> spectrumRxParams)
   if (!lrWpanRxParams)
   	return;
 
-  // Check to make sure the received signal is in our channel.
+  // Close the chunk of any frame being received since the arriving signal changes its SINR.
+  UpdateRxChunk ();
+
+  // Every signal delivered is tracked as potential interference, even if it is outside our channel, so
+  // the in-band power can be recomputed if the receiver hops channels while the signal is on the medium.
+  // With a partitioning FishSpectrumChannel only in-band signals arrive here, and signals already on a
+  // band the receiver hops to are added by UpdateChannelRxBand().
   double linNoiseFloor = pow(10.0, m_noiseFloorDbm / 10.0) / 1000.0;
-  if( (*(spectrumRxParams->psd))[m_phyPIBAttributes.phyCurrentChannel - 11]*2.0e6 < linNoiseFloor )
+
+  ZigbeeRxSignal signal;
+  signal.m_id = m_rxSignalId++;
+  signal.m_psd = spectrumRxParams->psd;
+  signal.m_inBandPower = rxPower;
+  signal.m_isDetectable = rxPower >= linNoiseFloor;
+  m_rxSignals.push_back (signal);
+
+  m_rxSignalPowerSum += rxPower;
+  m_rxTotalPower = m_noisePower + m_rxSignalPowerSum;
+
+  Time duration = lrWpanRxParams->duration;
+  Simulator::Schedule (duration, &ZigbeePhy::EndRxSignal, this, signal.m_id);
+
+  // Check to make sure the received signal is in our channel.
+  if( !signal.m_isDetectable )
   	return;
 
   // Increment the received signal counter to indicate that an 802.15.4 compliant signal has been
@@ -370,21 +534,24 @@ ZigbeePhy::StartRx (Ptr<SpectrumSignalParameters> spectrumRxParams)
   m_rxTotalNum++;
   NS_LOG_LOGIC(" Number of 802.15.4 signals in channel incremented to " << m_rxTotalNum);
 
-  Time duration = lrWpanRxParams->duration;
-  Simulator::Schedule (duration, &ZigbeePhy::DecrementChannelRxSignals, this);
-
   // If state is RX_ON, transition to BUSY_RX and process packet.
   if( m_trxState == IEEE_802_15_4_PHY_RX_ON ){
 
   	NS_LOG_LOGIC(" TRX in RX_ON, starting packet reception.");
-    m_phyTaskTrace(Mac16Address::ConvertFrom(m_device->GetAddress()), "Started receiving the packet from the channel");
+    m_phyTaskTrace(m_address, PHY_TASK_RX_START, 0);
 
   	Ptr<Packet> p = (lrWpanRxParams->packetBurst->GetPackets ()).front ();
 
   	m_currentRxPacket.m_packet = p;
   	m_currentRxPacket.m_isCorrupt = false;
   	m_rxPsd = lrWpanRxParams->psd;
-  	m_rxTotalPower = psdHelper.TotalAvgPower (*m_rxPsd);
+
+  	// Start the first SINR chunk.  It lasts until another signal arrives or leaves the medium.
+  	m_currentRxSignalId = signal.m_id;
+  	m_currentRxPower = rxPower;
+  	m_rxChunkStart = Simulator::Now ();
+  	m_rxChunkSuccess = 1.0;
+  	m_rxMinSinr = std::numeric_limits<double>::max ();
 
   	Simulator::Schedule (duration, &ZigbeePhy::EndRx, this);
   	m_phyRxBeginTrace (p);
@@ -396,21 +563,16 @@ ZigbeePhy::StartRx (Ptr<SpectrumSignalParameters> spectrumRxParams)
   }
 
   // If state is BUSY_RX, this means a collision has occured.
-  // - For now, drop both packets but this could be improved to an SNIR based method.
+  // - The arriving packet is dropped since the receiver is locked onto the current frame.
+  // - The arriving signal is now part of the interference seen by the current frame.  Whether the
+  //   current frame survives (is captured) is decided by the piecewise SINR in EndRx().
   if( m_trxState == IEEE_802_15_4_PHY_BUSY_RX ){
 
-  	NS_LOG_LOGIC(" TRX in RX_BUSY, dropping both packets.");
+  	NS_LOG_LOGIC(" TRX in RX_BUSY, dropping arriving packet and treating it as interference.");
 
-  	// Arriving packet doesn't even get placed in arrival trace.
-  	// GGM: This means that the channel will be occupied with corrupt, useless packets only until the end of the
-  	//      first packet.  It should actually remain occupied until the end of the last packet to transmit so
-  	//      channel congestion will be under-estimated.
   	Ptr<Packet> p = (lrWpanRxParams->packetBurst->GetPackets ()).front ();
   	m_phyRxDropTrace(p);
-  	m_infoDropTrace(Mac16Address::ConvertFrom(m_device->GetAddress()),p, "Phy is already busy receiving another packet.");
-
-  	// Flag current packet as corrupted.  Will be dropped by EndRx().
-  	m_currentRxPacket.m_isCorrupt = true;
+  	m_infoDropTrace(m_address,p, "Phy is already busy receiving another packet.");
 
   	return;
   }
@@ -424,7 +586,7 @@ ZigbeePhy::StartRx (Ptr<SpectrumSignalParameters> spectrumRxParams)
   std::stringstream strs;
   strs << "Phy is in state " << ZigbeePhyEnumNames[m_trxState] << ", and cannot receive packets.";
   msg = strs.str();
-  m_infoDropTrace(Mac16Address::ConvertFrom(m_device->GetAddress()),p, msg);
+  m_infoDropTrace(m_address,p, msg);
 
   return;
 
@@ -433,46 +595,46 @@ ZigbeePhy::StartRx (Ptr<SpectrumSignalParameters> spectrumRxParams)
 void ZigbeePhy::EndRx ()
 {
   NS_LOG_FUNCTION (this << " Time(s): " << Simulator::Now().GetSeconds());
-  m_phyTaskTrace(Mac16Address::ConvertFrom(m_device->GetAddress()), "Finished receiving a packet from the channel");
-  FishWpanSpectrumValueHelper psdHelper;
+  m_phyTaskTrace(m_address, PHY_TASK_RX_END, 0);
+
+  // Close the last chunk of the frame.
+  UpdateRxChunk ();
 
   // If the packet is flagged as corrupt, drop immediately.
   if(m_currentRxPacket.m_isCorrupt){
 
   	NS_LOG_LOGIC(" Packet previously corrupted, dropping.");
   	m_phyRxDropTrace(m_currentRxPacket.m_packet);
-    m_infoDropTrace(Mac16Address::ConvertFrom(m_device->GetAddress()),m_currentRxPacket.m_packet, "Phy received another packet while receiving this one.");
+    m_infoDropTrace(m_address,m_currentRxPacket.m_packet, "Phy received another packet while receiving this one.");
   }
 
   // Use error model to determine if the packet is intact.
   else if (m_errorModel != 0){
 
-  	// The TotalAvgPower function integrates across the PSD.  Useful for frequency selective channels
-  	// later on.
-    double noiseFactor = pow(10.0, m_noiseFigureDbm / 10.0);
-  	double sinr = psdHelper.TotalAvgPower (*m_rxPsd) / psdHelper.TotalAvgPower (*m_noise) * spreadingGain / noiseFactor;
+  	// The reported SINR is the worst chunk of the frame.
+  	double sinr = m_rxMinSinr;
 
   	// The received power of the signal
-    double rxPowerDbm = 10*log10(psdHelper.TotalAvgPower(*m_rxPsd)*1000);
+    double rxPowerDbm = 10*log10(m_currentRxPower*1000);
 
   	NS_LOG_DEBUG(
   			" RxPower: " << rxPowerDbm << " dBm, " <<
-  			" NoisePower: " << 10*log10(psdHelper.TotalAvgPower(*m_noise)*1000/spreadingGain) << " dBm"
+  			" NoisePower: " << 10*log10(m_noisePower*1000/spreadingGain) << " dBm"
   	);
 
 
   	NS_ASSERT(m_currentRxPacket.m_packet);
   	Ptr<Packet> p = m_currentRxPacket.m_packet;
 
-  	// Simplified calculation; the chunk is the whole packet
-  	double per = 1.0 - m_errorModel->GetChunkSuccessRate (sinr, p->GetSize () * 8);
+  	// The success probabilities of the constant SINR chunks have been multiplied together.
+  	double per = 1.0 - m_rxChunkSuccess;
 
-  	NS_LOG_DEBUG(" PER: " << per << " for SNR " << 10*log10(sinr) << "dB and " << p->GetSize()*8 << " bits");
+  	NS_LOG_DEBUG(" PER: " << per << " for min SINR " << 10*log10(sinr) << "dB and " << p->GetSize()*8 << " bits");
 
   	// Packet ok.
   	if (m_random->GetValue (0,1.0) > per){
   		NS_LOG_DEBUG (" Reception success!");
-  		m_phyRxEndTrace (Mac16Address::ConvertFrom(m_device->GetAddress()), p, sinr);
+  		m_phyRxEndTrace (m_address, p, sinr);
   		if (!m_pdDataIndicationCallback.IsNull ()){
   			m_pdDataIndicationCallback (p->GetSize (), p, (uint32_t)sinr, rxPowerDbm);
   		}
@@ -481,7 +643,7 @@ void ZigbeePhy::EndRx ()
   	else{
   		NS_LOG_DEBUG (" Reception failure!");
   		m_phyRxDropTrace (p);
-  	  m_infoDropTrace(Mac16Address::ConvertFrom(m_device->GetAddress()),p, "Phy determined that bits were randomly corrupted.");
+  	  m_infoDropTrace(m_address,p, "Phy determined that bits were randomly corrupted.");
   	}
   }
 
@@ -489,16 +651,17 @@ void ZigbeePhy::EndRx ()
   else{
   	NS_LOG_WARN ("Missing ErrorModel");
   	Ptr<Packet> p = m_currentRxPacket.m_packet;
-  	m_phyRxEndTrace (Mac16Address::ConvertFrom(m_device->GetAddress()), p, 0);
+  	m_phyRxEndTrace (m_address, p, 0);
 
   	if (!m_pdDataIndicationCallback.IsNull ()){
   		m_pdDataIndicationCallback (p->GetSize (), p, 0, 0);
   	}
   }
 
-  m_rxTotalPower = psdHelper.TotalAvgPower (*m_noise);
   m_currentRxPacket.m_packet = 0;
   m_currentRxPacket.m_isCorrupt = false;
+  m_currentRxPower = 0.0;
+  m_rxChunkSuccess = 1.0;
 
   // Check if a state change has been requested during the received frame.
   if (m_trxStatePending != IEEE_802_15_4_PHY_IDLE){
@@ -521,14 +684,14 @@ void
 ZigbeePhy::PdDataRequest (const uint32_t psduLength, Ptr<Packet> p)
 {
   NS_LOG_FUNCTION (this << psduLength << *p << " Time of Request: " << Simulator::Now().GetSeconds());
-  m_phyTaskTrace(Mac16Address::ConvertFrom(m_device->GetAddress()), "Requested to transmit a packet");
+  m_phyTaskTrace(m_address, PHY_TASK_TX_REQUEST, 0);
 
   // Don't transmit if sleeping
   if (m_trxState == PHY_SLEEP){
     if (!m_pdDataConfirmCallback.IsNull ())
     {
       m_pdDataConfirmCallback (PHY_SLEEP);
-      m_infoDropTrace(Mac16Address::ConvertFrom(m_device->GetAddress()),p, "Phy rejected data request because phy is sleeping.");
+      m_infoDropTrace(m_address,p, "Phy rejected data request because phy is sleeping.");
     }
     return;
   }
@@ -540,7 +703,7 @@ ZigbeePhy::PdDataRequest (const uint32_t psduLength, Ptr<Packet> p)
           m_pdDataConfirmCallback (IEEE_802_15_4_PHY_UNSPECIFIED);
         }
       NS_LOG_DEBUG ("Drop packet because psduLength too long: " << psduLength);
-      m_infoDropTrace(Mac16Address::ConvertFrom(m_device->GetAddress()),p, "Phy rejected data request because packet is too long.");
+      m_infoDropTrace(m_address,p, "Phy rejected data request because packet is too long.");
 
       return;
     }
@@ -563,7 +726,8 @@ ZigbeePhy::PdDataRequest (const uint32_t psduLength, Ptr<Packet> p)
   	Ptr<FishWpanSpectrumSignalParameters> txParams = Create<FishWpanSpectrumSignalParameters> ();
   	txParams->duration = Seconds (p->GetSize() * 8.0 / m_bitRate);
   	txParams->txPhy = GetObject<SpectrumPhy> ();
-  	txParams->psd = m_txPsd;
+  	// The signal parameters hold a mutable PSD, so the shared tx PSD is copied rather than handed out.
+  	txParams->psd = m_txPsd->Copy ();
   	txParams->txAntenna = m_antenna;
 
   	Ptr<PacketBurst> pb = CreateObject<PacketBurst> ();
@@ -575,7 +739,7 @@ ZigbeePhy::PdDataRequest (const uint32_t psduLength, Ptr<Packet> p)
 
 
   	m_channel->StartTx (txParams);
-    m_phyTaskTrace(Mac16Address::ConvertFrom(m_device->GetAddress()), "Started transmitting a packet");
+    m_phyTaskTrace(m_address, PHY_TASK_TX_START, 0);
 
   	m_phyTxBeginTrace (p);
   	m_currentTxPacket.m_packet = p;
@@ -597,7 +761,7 @@ ZigbeePhy::PdDataRequest (const uint32_t psduLength, Ptr<Packet> p)
   	std::stringstream ss;
     ss << "Phy is in state " << m_trxState << ", and cannot transmit packets.";
     std::string msg = ss.str();
-    m_infoDropTrace(Mac16Address::ConvertFrom(m_device->GetAddress()),p, msg);
+    m_infoDropTrace(m_address,p, msg);
   	return;
   }
 }
@@ -607,7 +771,7 @@ void
 ZigbeePhy::EndTx ()
 {
   NS_LOG_FUNCTION (this);
-  m_phyTaskTrace(Mac16Address::ConvertFrom(m_device->GetAddress()), "Finished transmitting a packet");
+  m_phyTaskTrace(m_address, PHY_TASK_TX_END, 0);
 
   if (m_currentTxPacket.m_isCorrupt == false){
 
@@ -621,7 +785,7 @@ ZigbeePhy::EndTx ()
   else{
   	NS_LOG_DEBUG (" Packet transmission aborted");
   	m_phyTxDropTrace (m_currentTxPacket.m_packet);
-    m_infoDropTrace(Mac16Address::ConvertFrom(m_device->GetAddress()),m_currentTxPacket.m_packet, "Phy changed channels during transmission and corrupted the packet.");
+    m_infoDropTrace(m_address,m_currentTxPacket.m_packet, "Phy changed channels during transmission and corrupted the packet.");
 
   	if (!m_pdDataConfirmCallback.IsNull ()){
   		m_pdDataConfirmCallback (m_trxState);
@@ -668,7 +832,7 @@ void
 ZigbeePhy::PlmeCcaRequest (void)
 {
   NS_LOG_FUNCTION (this);
-  m_phyTaskTrace(Mac16Address::ConvertFrom(m_device->GetAddress()), "Requested to perform CCA");
+  m_phyTaskTrace(m_address, PHY_TASK_CCA_REQUEST, 0);
 
   // Do not process CCA requests if sleeping
   if (m_trxState == PHY_SLEEP){
@@ -700,7 +864,7 @@ void
 ZigbeePhy::EndCca ()
 {
   NS_LOG_FUNCTION (this << Simulator::Now().GetSeconds());
-  m_phyTaskTrace(Mac16Address::ConvertFrom(m_device->GetAddress()), "Finished CCA");
+  m_phyTaskTrace(m_address, PHY_TASK_CCA_END, 0);
   ZigbeePhyEnumeration sensedChannelState;
 
   double linSensitivity = pow (10.0, m_rxSensitivityDbm / 10.0) / 1000.0;
@@ -861,12 +1025,7 @@ void ZigbeePhy::PlmeSetTRXStateRequest (ZigbeePhyEnumeration state)
 
   // Prevent the trace from being flooded from each process link rx on request if nothing is happening
   if (state != IEEE_802_15_4_PHY_RX_ON)
-  {
-    std::stringstream ss;
-    ss << "Requested to change state to " << ZigbeePhyEnumNames[state];
-    std::string msg = ss.str();
-    m_phyTaskTrace(Mac16Address::ConvertFrom(m_device->GetAddress()), msg);
-  }
+    m_phyTaskTrace(m_address, PHY_TASK_TRX_STATE_REQUEST, state);
 
   /*
    * ZigbeeModification:
@@ -1000,14 +1159,14 @@ ZigbeePhy::PlmeSetAttributeRequest (ZigbeePibAttributeIdentifier id,
               }
 
             NS_LOG_LOGIC(" phyCurrentChannel: Changing channel from " << (uint16_t)m_phyPIBAttributes.phyCurrentChannel << " to " << (uint16_t)attribute->phyCurrentChannel);
-            std::stringstream ss;
-            ss << "Changing the channel from " << (uint16_t)m_phyPIBAttributes.phyCurrentChannel << " to " << (uint16_t)attribute->phyCurrentChannel;
-            std::string msg = ss.str();
-            m_phyTaskTrace(Mac16Address::ConvertFrom(m_device->GetAddress()), msg);
+            m_phyTaskTrace(m_address, PHY_TASK_CHANNEL_CHANGE, attribute->phyCurrentChannel);
 
+            UpdateRxChunk ();
             m_phyPIBAttributes.phyCurrentChannel = attribute->phyCurrentChannel;
-            FishWpanSpectrumValueHelper psdHelper;
-            m_txPsd = psdHelper.CreateTxPowerSpectralDensity (m_phyPIBAttributes.phyTransmitPower, m_phyPIBAttributes.phyCurrentChannel);
+            UpdateTxPsd ();
+            UpdateNoisePower ();
+            RecalculateRxSignalPower ();
+            UpdateChannelRxBand ();
           }
         else
         	NS_LOG_LOGIC(" phyCurrentChannel: Channel already set to " << (uint16_t)m_phyPIBAttributes.phyCurrentChannel);
@@ -1035,19 +1194,11 @@ ZigbeePhy::PlmeSetAttributeRequest (ZigbeePibAttributeIdentifier id,
         else
           {
             m_phyPIBAttributes.phyTransmitPower = attribute->phyTransmitPower;
-            FishWpanSpectrumValueHelper psdHelper;
-            int8_t txPower = ((int8_t)m_phyPIBAttributes.phyTransmitPower);
-            txPower <<= 2;
-            txPower >>= 2;
-            m_txPsd = psdHelper.CreateTxPowerSpectralDensity (txPower, m_phyPIBAttributes.phyCurrentChannel);
+            int8_t txPower = UpdateTxPsd ();
 
-            std::stringstream ss;
-            ss << "Setting the transmit power to " << (int16_t)txPower << " dBm";
-            std::string msg = ss.str();
+            NS_LOG_DEBUG("Setting the transmit power to " << (int16_t)txPower << " dBm");
 
-            NS_LOG_DEBUG(msg);
-
-            m_phyTaskTrace(Mac16Address::ConvertFrom(m_device->GetAddress()), msg);
+            m_phyTaskTrace(m_address, PHY_TASK_TX_POWER_CHANGE, txPower);
 
             m_currentDraws->UpdateTxCurrent(txPower);
             UpdateBattery();
@@ -1081,10 +1232,13 @@ ZigbeePhy::PlmeSetAttributeRequest (ZigbeePibAttributeIdentifier id,
 }
 
 void
-ZigbeePhy::SetBatteryCallback(BatteryDecrementCallback c)
+ZigbeePhy::SetBatteryCallback(BatteryPowerDrawCallback c, const vector<uint32_t> &categoryIds)
 {
 	NS_LOG_FUNCTION(this);
-	m_batteryDecrementCallback = c;
+	NS_ASSERT(categoryIds.size() == m_energyCategories.size());
+	m_batteryCallback = c;
+	m_energyCategoryIds = categoryIds;
+	m_batteryCallback(m_energyCategoryIds[m_energyCategory], m_current * m_supplyVoltage * 1e6);
 }
 
 void
@@ -1151,8 +1305,7 @@ ZigbeePhy::ChangeTrxState (ZigbeePhyEnumeration newState)
 
   // Change state
   if(m_device != 0){
-    Mac16Address addr = Mac16Address::ConvertFrom(m_device->GetAddress());
-    m_trxStateLogger (addr,ZigbeePhyEnumNames[m_trxState], ZigbeePhyEnumNames[newState]);
+    m_trxStateLogger (m_address,ZigbeePhyEnumNames[m_trxState], ZigbeePhyEnumNames[newState]);
   }
   m_trxState = newState;
 
@@ -1189,6 +1342,37 @@ ZigbeePhy::SetNoisePowerSpectralDensity (Ptr<const SpectrumValue> noisePsd)
   NS_LOG_INFO ("\t computed noise_psd: " << *noisePsd );
   NS_ASSERT (noisePsd);
   m_noise = noisePsd;
+  UpdateNoisePower ();
+}
+
+int8_t
+ZigbeePhy::UpdateTxPsd (void)
+{
+  // Sign extend the 6 bit tx power.
+  int8_t txPower = ((int8_t)m_phyPIBAttributes.phyTransmitPower);
+  txPower <<= 2;
+  txPower >>= 2;
+
+  // Shared PSDs make channel hops and power changes a pointer swap.
+  m_txPsd = FishWpanSpectrumValueHelper::GetTxPowerSpectralDensity (txPower, m_phyPIBAttributes.phyCurrentChannel);
+
+  return txPower;
+}
+
+void
+ZigbeePhy::UpdateNoisePower (void)
+{
+  m_noisePower = FishWpanSpectrumValueHelper::InBandPower (*m_noise, m_phyPIBAttributes.phyCurrentChannel);
+
+  // A noise PSD that doesn't cover the current channel (eg. the default one created for channel 11)
+  // is treated as the noise of every channel.
+  if (m_noisePower == 0.0)
+    {
+      FishWpanSpectrumValueHelper psdHelper;
+      m_noisePower = psdHelper.TotalAvgPower (*m_noise);
+    }
+
+  m_rxTotalPower = m_noisePower + m_rxSignalPowerSum;
 }
 
 Ptr<const SpectrumValue>
@@ -1218,6 +1402,9 @@ ZigbeePhy::SetSupplyVoltage (double voltage)
 {
   NS_LOG_FUNCTION (this);
   m_supplyVoltage = voltage;
+
+  if(!m_batteryCallback.IsNull())
+  	m_batteryCallback(m_energyCategoryIds[m_energyCategory], m_current * m_supplyVoltage * 1e6);
 }
 
 double
@@ -1259,26 +1446,12 @@ ZigbeePhy::UpdateBattery (void)
 {
   NS_LOG_FUNCTION (this);
 
-  // Calculate the energy consumed since the last update.
-  Time duration = Simulator::Now () - m_lastUpdateTime;
-  NS_ASSERT (duration.GetNanoSeconds () >= 0);
-
-  // Energy is in uJ.
-  double energyConsumed = m_current * duration.GetSeconds() * m_supplyVoltage * 1e6;
-  if(!m_batteryDecrementCallback.IsNull())
-  	m_batteryDecrementCallback(m_energyCategory,energyConsumed);
-
-  NS_LOG_LOGIC("Consumed: " << energyConsumed << " uJ over " << duration.GetSeconds() << " s (" << m_current << " A, " << m_supplyVoltage << " V) (NxtState: " << m_trxState << ")");
-
-  // Update the current power consumption values.
-  m_lastUpdateTime = Simulator::Now();
-
   switch (m_trxState)
   {
     case IEEE_802_15_4_PHY_BUSY_RX:
     {
       m_current = m_currentDraws->GetBusyRxCurrentA();
-      m_energyCategory = "BusyRx";
+      m_energyCategory = PHY_ENERGY_BUSY_RX;
       break;
     }
 
@@ -1286,41 +1459,47 @@ ZigbeePhy::UpdateBattery (void)
     case IEEE_802_15_4_PHY_RX_ON:
     {
       m_current = m_currentDraws->GetRxOnCurrentA();
-      m_energyCategory = "RxOn";
+      m_energyCategory = PHY_ENERGY_RX_ON;
       break;
     }
 
     case IEEE_802_15_4_PHY_BUSY_TX:
     {
       m_current = m_currentDraws->GetBusyTxCurrentA();
-      m_energyCategory = "BusyTx";
+      m_energyCategory = PHY_ENERGY_BUSY_TX;
       break;
     }
 
     case IEEE_802_15_4_PHY_TX_ON:
     {
       m_current = m_currentDraws->GetTxOnCurrentA();
-      m_energyCategory = "TxOn";
+      m_energyCategory = PHY_ENERGY_TX_ON;
       break;
     }
 
     case IEEE_802_15_4_PHY_TRX_OFF:
     {
       m_current = m_currentDraws->GetTrxOffCurrentA();
-      m_energyCategory = "TrxOff";
+      m_energyCategory = PHY_ENERGY_TRX_OFF;
       break;
     }
 
     case PHY_SLEEP:
     {
       m_current = m_currentDraws->GetSleepCurrentA();
-      m_energyCategory = "PhySleep";
+      m_energyCategory = PHY_ENERGY_SLEEP;
       break;
     }
     default:
-      NS_FATAL_ERROR ("ZigbeeRadioEnergyModel:Invalid radio state: " << m_trxState);
+      NS_FATAL_ERROR ("ZigbeePhy:Invalid radio state: " << m_trxState);
   }
 
+  NS_LOG_LOGIC("Drawing " << m_current << " A at " << m_supplyVoltage << " V (State: " << m_trxState << ")");
+
+  // Power is in uJ/s.
+  if(!m_batteryCallback.IsNull())
+  	m_batteryCallback(m_energyCategoryIds[m_energyCategory], m_current * m_supplyVoltage * 1e6);
+
 }
 
 
@@ -77,6 +77,17 @@ typedef struct{
 	bool m_isCorrupt;  ///< Indicates whether the packet has been corrupted by interference.
 } PacketAndStatus;
 
+/** Structure describing a signal currently present on the medium at the receiver.
+ * - Signals are tracked from StartRx() until the end of their duration so the
+ *   interference seen by a frame being received can be integrated piecewise.
+ */
+typedef struct{
+	uint32_t m_id;  ///< Identifier used to remove the signal when it leaves the medium.
+	Ptr<const SpectrumValue> m_psd;  ///< Received PSD (shared with the channel, not copied).
+	double m_inBandPower;  ///< Power (W) of the signal in the currently selected channel.
+	bool m_isDetectable;  ///< Signal is above the noise floor and counted in m_rxTotalNum.
+} ZigbeeRxSignal;
+
 
 
 /** Enum defining operational state of PHY transceiver.
@@ -154,6 +165,45 @@ typedef enum
 	phyDropTx=0x02
 }ZigbeePhyDropSource;
 
+/** Energy consumption categories of the PHY.
+ * - Indexes the names returned by ZigbeePhy::GetEnergyCategories().
+ */
+typedef enum
+{
+  PHY_ENERGY_BROADCAST = 0,
+  PHY_ENERGY_DATA,
+  PHY_ENERGY_ACK,
+  PHY_ENERGY_BUSY_RX,
+  PHY_ENERGY_RX_ON,
+  PHY_ENERGY_TX_ON,
+  PHY_ENERGY_TRX_OFF,
+  PHY_ENERGY_BUSY_TX,
+  PHY_ENERGY_SLEEP
+} ZigbeePhyEnergyCategory;
+
+/** Events reported by the PhyTaskTrace source.
+ * - Each event is traced with a value whose meaning is given in ZigbeePhyTaskEventNames.
+ * - Sinks format the event themselves, so an unconnected trace source costs nothing.
+ */
+typedef enum
+{
+  PHY_TASK_ENDED = 0,
+  PHY_TASK_RX_ARRIVED,
+  PHY_TASK_RX_START,
+  PHY_TASK_RX_END,
+  PHY_TASK_TX_REQUEST,
+  PHY_TASK_TX_START,
+  PHY_TASK_TX_END,
+  PHY_TASK_CCA_REQUEST,
+  PHY_TASK_CCA_END,
+  PHY_TASK_TRX_STATE_REQUEST,
+  PHY_TASK_CHANNEL_CHANGE,
+  PHY_TASK_TX_POWER_CHANGE
+} ZigbeePhyTaskEvent;
+
+// Matching descriptions of ZigbeePhyTaskEvent used for readable printing (make sure cpp definition matches above enum)
+extern const char * ZigbeePhyTaskEventNames[];
+
 /** Callback to transfer PHY service data unit (PSDU) to MAC layer.
  * - Denoted PD-DATA.indication in the standard.
  * - Transfers phy service data unit (PSDU) to MAC layer where it becomes
@@ -254,15 +304,31 @@ public:
   static const uint32_t aMaxPhyPacketSize; ///< Table 22 in section 6.4.1 of ieee802.15.4
   static const uint32_t aTurnaroundTime;   ///< Table 22 in section 6.4.1 of ieee802.15.4
 
+  /** Signature of the PhyTaskTrace source.
+   *
+   * @param addr Address of the node.
+   * @param event The event that occurred.
+   * @param value Event dependent value (see ZigbeePhyTaskEventNames).
+   */
+  typedef void (* TaskEventTracedCallback)(Mac16Address addr, ZigbeePhyTaskEvent event, double value);
+
   ZigbeePhy ();
   virtual ~ZigbeePhy ();
 
   /** Set the NetDevice instance associated with this PHY.
+   * - The address of the device is cached for tracing.
    *
    * @param d the NetDevice instance
    */
    void SetDevice (Ptr<NetDevice> d);
 
+  /** Set the address reported by the PHY trace sources.
+   * - Must be called if the address of the device changes after SetDevice().
+   *
+   * @param address The 16 bit address of the device.
+   */
+  void SetAddress (Mac16Address address);
+
   /** Get the NetDevice instance associated with this PHY.
    *
    * @return a Ptr to the associated NetDevice instance
@@ -389,11 +455,13 @@ public:
    */
   void PlmeSetAttributeRequest (ZigbeePibAttributeIdentifier id, ZigbeePhyPIBAttributes* attribute);
 
-  /** Set callback to the function that decrements battery energy. (GGM)
+  /** Set the callback used to report transceiver state changes to the battery. (GGM)
+   * - The battery integrates the consumption, the current draw is reported immediately.
    *
    * @param c Callback function.
+   * @param categoryIds Battery IDs of the categories returned by GetEnergyCategories().
    */
-  void SetBatteryCallback(BatteryDecrementCallback c);
+  void SetBatteryCallback(BatteryPowerDrawCallback c, const vector<uint32_t> &categoryIds);
 
   /** Set the received data callback.
    * Callback occurs at the end of an RX as part of the
@@ -511,7 +579,7 @@ private:
 
 
   /**
-   * Update the how much energy the PHY transceiver has consumed from the battery. (GGM)
+   * Report the current drawn by the PHY transceiver in its new state to the battery. (GGM)
    */
   void UpdateBattery();
 
@@ -530,15 +598,17 @@ private:
   bool ChannelSupported (uint8_t);
   Ptr<MobilityModel> m_mobility;
   Ptr<NetDevice> m_device;
+  Mac16Address m_address;  ///< Cached address of m_device used by the trace sources.
   Ptr<SpectrumChannel> m_channel;
   Ptr<AntennaModel> m_antenna;
-  Ptr<SpectrumValue> m_txPsd;
+  Ptr<const SpectrumValue> m_txPsd;  ///< Tx PSD, usually shared with other PHYs so never modified.
   Ptr<const SpectrumValue> m_rxPsd;
   Ptr<const SpectrumValue> m_noise;
   Ptr<Isa100ErrorModel> m_errorModel;
   ZigbeePhyPIBAttributes m_phyPIBAttributes;
 
   vector<string> m_energyCategories;  /// Energy consumption categories.
+  vector<uint32_t> m_energyCategoryIds;  /// Battery ID of each energy consumption category.
 
   Ptr<Packet> m_lastTxPacket;
   double m_bitRate;     ///< phy bit rate in bits/sec
@@ -546,17 +616,56 @@ private:
 
 
 
-  Time m_lastUpdateTime;
   double m_current;
   double m_supplyVoltage;
-  string m_energyCategory;
+  ZigbeePhyEnergyCategory m_energyCategory;  ///< Category of the current energy consumption.
   Ptr<ZigbeeTrxCurrentModel> m_currentDraws;
   Time m_wakeUpDuration;
 
-  /** Decrement the number of active signals in the channel.
+  /** Remove a signal from the medium once its duration has elapsed.
+   * - Closes the current SINR chunk if a frame is being received.
+   * - Decrements the number of active signals in the channel.
+   *
+   * @param signalId Identifier assigned to the signal in StartRx().
+   */
+  void EndRxSignal (uint32_t signalId);
+
+  /** Close the current reception chunk.
+   * - The SINR has been constant since m_rxChunkStart, so the chunk success probability
+   *   is folded into m_rxChunkSuccess and a new chunk is started at the current time.
+   * - Must be called before any change to m_rxSignalPowerSum.
+   */
+  void UpdateRxChunk (void);
+
+  /** Tell a FishSpectrumChannel which band the receiver is tuned to.
+   * - Lets the channel skip delivering signals on other channels to this PHY.
+   */
+  void UpdateChannelRxBand (void);
+
+  /** Add a signal that was already on the medium when the receiver tuned to its band.
+   * - The signal only counts as interference, the receiver never locks onto it.
    *
+   * @param spectrumRxParams Received signal with its remaining duration.
+   */
+  void AddRxInterference (Ptr<SpectrumSignalParameters> spectrumRxParams);
+
+  /** Point m_txPsd at the shared PSD for the current tx power and channel.
+   * - phyTransmitPower is a 6 bit two's complement value (dBm).
+   *
+   * @return The nominal tx power (dBm).
+   */
+  int8_t UpdateTxPsd (void);
+
+  /** Update the cached noise power for the current channel.
+   * - Called when the noise PSD or the channel changes so the receive path never integrates the noise PSD.
+   */
+  void UpdateNoisePower (void);
+
+  /** Recompute the in-band power of every signal on the medium.
+   * - Called when the receiver changes channels.
+   * - Also updates m_currentRxPower so the rest of a frame being received uses its power in the new band.
    */
-  void DecrementChannelRxSignals();
+  void RecalculateRxSignalPower (void);
 
   // State variables
   ZigbeePhyEnumeration m_trxState;  /// transceiver state
@@ -614,7 +723,13 @@ private:
   TracedCallback<Ptr<const Packet> > m_phyRxDropTrace;
 
   TracedCallback<Mac16Address, Ptr<const Packet>, std::string> m_infoDropTrace;
-  TracedCallback<Mac16Address, std::string> m_phyTaskTrace;
+
+  /**
+   * The trace source fired on each PHY task (state change requests, CCA, Tx and Rx).
+   *
+   * \see class CallBackTraceSource
+   */
+  TracedCallback<Mac16Address, ZigbeePhyTaskEvent, double> m_phyTaskTrace;
 
   PdDataIndicationCallback m_pdDataIndicationCallback;
   PdDataConfirmCallback m_pdDataConfirmCallback;
@@ -625,7 +740,7 @@ private:
   PlmeSetAttributeConfirmCallback m_plmeSetAttributeConfirmCallback;
   PhyDropCallback m_phyDropCallback;
 
-  BatteryDecrementCallback m_batteryDecrementCallback;
+  BatteryPowerDrawCallback m_batteryCallback;  /// Callback function used to report the power drawn from the battery.
 
 
 
@@ -639,6 +754,17 @@ private:
   PacketAndStatus m_currentRxPacket;
   PacketAndStatus m_currentTxPacket;
 
+  // Interference tracking
+  std::vector<ZigbeeRxSignal> m_rxSignals;  ///< Signals currently present on the medium.
+  uint32_t m_rxSignalId;           ///< Identifier assigned to the next arriving signal.
+  double m_rxSignalPowerSum;       ///< In-band power (W) of all signals on the medium.
+  double m_noisePower;             ///< In-band noise power (W) of the current channel, cached from m_noise.
+  uint32_t m_currentRxSignalId;    ///< Identifier of the signal carrying m_currentRxPacket.
+  double m_currentRxPower;         ///< In-band power (W) of the signal being received.
+  Time m_rxChunkStart;             ///< Start of the current constant SINR chunk.
+  double m_rxChunkSuccess;         ///< Success probability of the chunks received so far.
+  double m_rxMinSinr;              ///< Lowest chunk SINR seen during the current reception.
+
   EventId m_edRequest;
   EventId m_setTRXState;
   EventId m_pdDataRequest;